@@ -0,0 +1,208 @@
+#pragma once
+
+// Batch queries: many independent start/goal pairs against one static grid,
+// spread over a ThreadPool (thread_pool.hpp). The grid, its component labels (and
+// the JPS+ table, JPS bitboards, HPA* graph or landmarks, if one is needed)
+// are shared read-only; each worker owns its search buffers and reuses them
+// for all its queries, so workers never write to shared memory except their
+// own result slots. With a PathCache, workers answer what they can from it
+// and add what they search; the cache locks itself.
+//
+// A distance matrix between many sources and many targets runs one flood per
+// source instead of one search per pair: each flood settles cells in cost
+// order until it has reached every target it can, then fills its whole row.
+// With fewer targets than sources the floods run backwards from the targets
+// and fill columns instead.
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "components.hpp"
+#include "flow_field.hpp"
+#include "grid.hpp"
+#include "hpa.hpp"
+#include "jps.hpp"
+#include "path_cache.hpp"
+#include "search.hpp"
+#include "search_space.hpp"
+#include "thread_pool.hpp"
+
+namespace pathfinder {
+
+struct Query {
+    Cell start;
+    Cell goal;
+};
+
+// Workers take this many queries at a time, few enough that a thread left
+// behind a long chunk can steal the rest of its run
+const int BATCH_CHUNK = 16;
+
+// Runs every query on the pool and returns the results in query order. The
+// grid must not change while the batch runs. A* and greedy best-first use
+// the landmarks if given and current (see Search). Throws std::out_of_range
+// if a query leaves the grid.
+inline std::vector<SearchResult> findPaths(const Grid& grid, Algorithm algorithm, const std::vector<Query>& queries,
+                                           ThreadPool& pool, const Movement& movement = Movement(),
+                                           const LandmarkTable* landmarks = nullptr, PathCache* cache = nullptr) {
+    for (const Query& query : queries) {
+        if (!grid.contains(query.start) || !grid.contains(query.goal)) {
+            throw std::out_of_range("query endpoint lies outside the grid");
+        }
+    }
+
+    // Built once up front instead of once per worker
+    ComponentMap components(grid);
+    bool fourWay = movement.connectivity == Connectivity::Four;
+    std::unique_ptr<JumpTable> jumpTable;
+    if (algorithm == Algorithm::JumpPointPlus && grid.uniformCost() && fourWay) {
+        jumpTable.reset(new JumpTable(grid));
+    }
+    std::unique_ptr<JumpScanner> jumpScanner;
+    if (algorithm == Algorithm::JumpPoint && grid.uniformCost() && fourWay) {
+        jumpScanner.reset(new JumpScanner(grid));
+    }
+    std::unique_ptr<HierarchicalMap> hierarchy;
+    if (algorithm == Algorithm::Hierarchical && fourWay) {
+        hierarchy.reset(new HierarchicalMap(grid));
+    }
+    SearchTables tables;
+    tables.jumpTable = jumpTable.get();
+    tables.jumpScanner = jumpScanner.get();
+    tables.hierarchy = hierarchy.get();
+    tables.components = &components;
+    tables.landmarks = landmarks;
+
+    // Search buffers per pool thread, allocated by the thread on its first chunk
+    struct Worker {
+        SearchSpace space;
+        SearchSpace reverseSpace;
+        SearchScratch scratch;
+    };
+    std::vector<std::unique_ptr<Worker>> workers(pool.size());
+    std::vector<SearchResult> results(queries.size());
+    pool.parallelFor(static_cast<int>(queries.size()), BATCH_CHUNK, [&](int begin, int end, int thread) {
+        std::unique_ptr<Worker>& worker = workers[thread];
+        if (!worker) {
+            worker.reset(new Worker());
+            worker->space.resize(grid.cellCount());
+        }
+        for (int i = begin; i < end; ++i) {
+            const Query& query = queries[i];
+            if (cache && cache->lookup(grid, algorithm, movement, query.start, query.goal, results[i])) {
+                continue;
+            }
+            Search search(grid, worker->space, algorithm, query.start, query.goal, nullptr, tables, movement,
+                          &worker->reverseSpace, &worker->scratch);
+            results[i] = search.run();
+            if (cache) {
+                cache->store(grid, algorithm, movement, query.start, query.goal, results[i]);
+            }
+        }
+    });
+    return results;
+}
+
+// The same on a pool of its own; threadCount 0 uses one thread per hardware
+// thread, and no more threads start than there are chunks of queries
+inline std::vector<SearchResult> findPaths(const Grid& grid, Algorithm algorithm, const std::vector<Query>& queries,
+                                           int threadCount = 0, const Movement& movement = Movement(),
+                                           const LandmarkTable* landmarks = nullptr, PathCache* cache = nullptr) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    int chunks = static_cast<int>((queries.size() + BATCH_CHUNK - 1) / BATCH_CHUNK);
+    ThreadPool pool(std::max(1, std::min(threadCount, chunks)));
+    return findPaths(grid, algorithm, queries, pool, movement, landmarks, cache);
+}
+
+struct DistanceMatrix {
+    int sourceCount = 0;
+    int targetCount = 0;
+    // Row per source, SearchSpace::UNREACHED where there is no path, in the
+    // movement's distance units (see flow_field.hpp)
+    std::vector<int> distances;
+
+    int at(int source, int target) const { return distances[static_cast<size_t>(source) * targetCount + target]; }
+};
+
+// Cheapest distance from every source to every target under the movement,
+// one flood per pool thread at a time. Throws std::out_of_range if a cell
+// lies outside the grid.
+inline DistanceMatrix distanceMatrix(const Grid& grid, const std::vector<Cell>& sources,
+                                     const std::vector<Cell>& targets, ThreadPool& pool,
+                                     const Movement& movement = Movement()) {
+    for (const std::vector<Cell>* cells : {&sources, &targets}) {
+        for (const Cell& cell : *cells) {
+            if (!grid.contains(cell)) {
+                throw std::out_of_range("distance matrix cell lies outside the grid");
+            }
+        }
+    }
+    DistanceMatrix matrix;
+    matrix.sourceCount = static_cast<int>(sources.size());
+    matrix.targetCount = static_cast<int>(targets.size());
+    matrix.distances.assign(sources.size() * targets.size(), SearchSpace::UNREACHED);
+    if (sources.empty() || targets.empty()) {
+        return matrix;
+    }
+
+    // Floods start from the smaller side; the other side's cells are marks,
+    // chained so that several marks can share a cell
+    bool backwards = targets.size() < sources.size();
+    const std::vector<Cell>& roots = backwards ? targets : sources;
+    const std::vector<Cell>& marks = backwards ? sources : targets;
+    std::vector<int> firstMark(grid.cellCount(), -1);
+    std::vector<int> nextMark(marks.size(), -1);
+    for (int i = static_cast<int>(marks.size()) - 1; i >= 0; --i) {
+        int index = grid.index(marks[i]);
+        nextMark[i] = firstMark[index];
+        firstMark[index] = i;
+    }
+    // A flood stops once it has settled every mark it can reach, which the
+    // component labels tell unless diagonal steps may cut corners
+    ComponentMap components(grid);
+    bool labelsApply = movement.connectivity == Connectivity::Four || movement.corners == CornerRule::NoCut;
+
+    std::vector<detail::FloodBuffers> buffersOf(pool.size());
+    pool.parallelFor(static_cast<int>(roots.size()), 1, [&](int begin, int end, int thread) {
+        detail::FloodBuffers& buffers = buffersOf[thread];
+        for (int root = begin; root < end; ++root) {
+            int rootIndex = grid.index(roots[root]);
+            int remaining = 0;
+            for (const Cell& mark : marks) {
+                remaining += !labelsApply || components.connected(rootIndex, grid.index(mark)) ? 1 : 0;
+            }
+            if (remaining == 0) {
+                continue;
+            }
+            detail::flood(grid, rootIndex, movement, backwards, buffers, [&](int index) {
+                for (int mark = firstMark[index]; mark >= 0; mark = nextMark[mark]) {
+                    size_t slot = backwards ? mark * targets.size() + root : root * targets.size() + mark;
+                    matrix.distances[slot] = buffers.space.g(index);
+                    --remaining;
+                }
+                return remaining > 0;
+            });
+        }
+    });
+    return matrix;
+}
+
+// The same on a pool of its own; threadCount 0 uses one thread per hardware
+// thread, and no more threads start than there are floods
+inline DistanceMatrix distanceMatrix(const Grid& grid, const std::vector<Cell>& sources,
+                                     const std::vector<Cell>& targets, int threadCount = 0,
+                                     const Movement& movement = Movement()) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    int floods = static_cast<int>(std::min(sources.size(), targets.size()));
+    ThreadPool pool(std::max(1, std::min(threadCount, floods)));
+    return distanceMatrix(grid, sources, targets, pool, movement);
+}
+
+} // namespace pathfinder
@@ -0,0 +1,232 @@
+#pragma once
+
+// Bitboards: one bit per cell, with every row padded to whole 64-bit words so
+// a word never straddles two rows. Bit c % 64 of word c / 64 in a row is
+// column c; padding bits stay clear.
+//
+// Row kernels work on WordVector, several words side by side: four (256
+// cells) when the compiler targets AVX2 (-mavx2 or -march=native), two on any
+// other x86-64 build, and a plain 64-bit word elsewhere. Kernels are written
+// once against it, so all three give the same results. The bottom-up step of
+// the parallel breadth-first search (parallel_flood.hpp) sweeps whole rows
+// with them. JumpScanner stays a word at a time: its vertical runs mostly
+// end within a word or two, where loading a vector costs more than it saves.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "grid.hpp"
+
+namespace pathfinder {
+
+namespace detail {
+
+inline int countTrailingZeros(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int count = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline int countLeadingZeros(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(word);
+#else
+    int count = 0;
+    while (!(word & (static_cast<std::uint64_t>(1) << 63))) {
+        word <<= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// WIDTH consecutive words, loaded from and stored to any address
+#if defined(__AVX2__)
+struct WordVector {
+    static const int WIDTH = 4;
+    __m256i bits;
+
+    static WordVector load(const std::uint64_t* words) {
+        return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words))};
+    }
+    void store(std::uint64_t* words) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(words), bits); }
+    bool any() const { return !_mm256_testz_si256(bits, bits); }
+    // Every word shifted towards higher (shiftUp) or lower bits on its own
+    template <int N>
+    WordVector shiftUp() const { return {_mm256_slli_epi64(bits, N)}; }
+    template <int N>
+    WordVector shiftDown() const { return {_mm256_srli_epi64(bits, N)}; }
+    WordVector operator|(const WordVector& other) const { return {_mm256_or_si256(bits, other.bits)}; }
+    WordVector operator&(const WordVector& other) const { return {_mm256_and_si256(bits, other.bits)}; }
+    // this & ~other
+    WordVector without(const WordVector& other) const { return {_mm256_andnot_si256(other.bits, bits)}; }
+    WordVector operator~() const { return {_mm256_xor_si256(bits, _mm256_set1_epi64x(-1))}; }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct WordVector {
+    static const int WIDTH = 2;
+    __m128i bits;
+
+    static WordVector load(const std::uint64_t* words) {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(words))};
+    }
+    void store(std::uint64_t* words) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(words), bits); }
+    bool any() const { return _mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128())) != 0xFFFF; }
+    template <int N>
+    WordVector shiftUp() const { return {_mm_slli_epi64(bits, N)}; }
+    template <int N>
+    WordVector shiftDown() const { return {_mm_srli_epi64(bits, N)}; }
+    WordVector operator|(const WordVector& other) const { return {_mm_or_si128(bits, other.bits)}; }
+    WordVector operator&(const WordVector& other) const { return {_mm_and_si128(bits, other.bits)}; }
+    WordVector without(const WordVector& other) const { return {_mm_andnot_si128(other.bits, bits)}; }
+    WordVector operator~() const { return {_mm_xor_si128(bits, _mm_set1_epi32(-1))}; }
+};
+#else
+struct WordVector {
+    static const int WIDTH = 1;
+    std::uint64_t bits;
+
+    static WordVector load(const std::uint64_t* words) { return {*words}; }
+    void store(std::uint64_t* words) const { *words = bits; }
+    bool any() const { return bits != 0; }
+    template <int N>
+    WordVector shiftUp() const { return {bits << N}; }
+    template <int N>
+    WordVector shiftDown() const { return {bits >> N}; }
+    WordVector operator|(const WordVector& other) const { return {bits | other.bits}; }
+    WordVector operator&(const WordVector& other) const { return {bits & other.bits}; }
+    WordVector without(const WordVector& other) const { return {bits & ~other.bits}; }
+    WordVector operator~() const { return {~bits}; }
+};
+#endif
+
+// One breadth-first step along a row of count words: the open, unvisited
+// cells beside a frontier cell in the row (here) or straight above or below
+// it go to reached and are marked visited. Returns whether any were.
+inline bool expandRow(const std::uint64_t* above, const std::uint64_t* here, const std::uint64_t* below,
+                      const std::uint64_t* open, std::uint64_t* visited, std::uint64_t* reached, int count) {
+    const std::uint64_t top = static_cast<std::uint64_t>(1) << 63;
+    bool any = false;
+    auto expandWord = [&](int w) {
+        std::uint64_t next = here[w] << 1 | here[w] >> 1 | above[w] | below[w];
+        if (w > 0 && (here[w - 1] & top)) {
+            next |= 1;
+        }
+        if (w + 1 < count && (here[w + 1] & 1)) {
+            next |= top;
+        }
+        next &= open[w] & ~visited[w];
+        reached[w] = next;
+        visited[w] |= next;
+        any = any || next;
+    };
+    // The vectors read one word to each side, so the row's first and last
+    // words go one at a time
+    int w = 0;
+    if (count > 0) {
+        expandWord(w++);
+    }
+    WordVector found = {};
+    for (; w + WordVector::WIDTH < count; w += WordVector::WIDTH) {
+        WordVector middle = WordVector::load(here + w);
+        WordVector next = middle.shiftUp<1>() | WordVector::load(here + w - 1).shiftDown<63>() |
+                          middle.shiftDown<1>() | WordVector::load(here + w + 1).shiftUp<63>() |
+                          WordVector::load(above + w) | WordVector::load(below + w);
+        WordVector seen = WordVector::load(visited + w);
+        next = (next & WordVector::load(open + w)).without(seen);
+        next.store(reached + w);
+        (seen | next).store(visited + w);
+        found = found | next;
+    }
+    for (; w < count; ++w) {
+        expandWord(w);
+    }
+    return any || found.any();
+}
+
+} // namespace detail
+
+class BitBoard {
+public:
+    BitBoard() : rowCount(0), colCount(0), rowWords(0) {}
+
+    BitBoard(int rows, int cols)
+        : rowCount(rows), colCount(cols), rowWords((cols + 63) / 64), words(static_cast<size_t>(rows) * rowWords, 0) {}
+
+    // The open cells of a grid
+    static BitBoard passability(const Grid& grid) {
+        BitBoard board(grid.rows(), grid.cols());
+        const std::uint64_t* flat = grid.passabilityWords();
+        for (int row = 0; row < grid.rows(); ++row) {
+            std::uint64_t* target = board.row(row);
+            size_t first = static_cast<size_t>(row) * grid.cols();
+            for (int col = 0; col < grid.cols(); col += 64) {
+                // 64 flat bits starting at an arbitrary bit offset
+                size_t bit = first + col;
+                size_t word = bit / 64;
+                int shift = static_cast<int>(bit % 64);
+                std::uint64_t value = flat[word] >> shift;
+                if (shift && (word + 1) * 64 < static_cast<size_t>(grid.cellCount())) {
+                    value |= flat[word + 1] << (64 - shift);
+                }
+                int width = grid.cols() - col;
+                if (width < 64) {
+                    value &= (static_cast<std::uint64_t>(1) << width) - 1;
+                }
+                target[col / 64] = value;
+            }
+        }
+        return board;
+    }
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    // Words per row
+    int stride() const { return rowWords; }
+
+    std::uint64_t* row(int r) { return words.data() + static_cast<size_t>(r) * rowWords; }
+    const std::uint64_t* row(int r) const { return words.data() + static_cast<size_t>(r) * rowWords; }
+
+    bool test(int r, int c) const { return (row(r)[c >> 6] >> (c & 63)) & 1; }
+    void set(int r, int c) { row(r)[c >> 6] |= static_cast<std::uint64_t>(1) << (c & 63); }
+
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+
+    // Rows become columns: bit r of row c in the result is bit c of row r here
+    BitBoard transposed() const {
+        BitBoard result(colCount, rowCount);
+        for (int r = 0; r < rowCount; ++r) {
+            const std::uint64_t* source = row(r);
+            for (int w = 0; w < rowWords; ++w) {
+                for (std::uint64_t word = source[w]; word; word &= word - 1) {
+                    result.set(w * 64 + detail::countTrailingZeros(word), r);
+                }
+            }
+        }
+        return result;
+    }
+
+    size_t memoryUsage() const { return words.capacity() * sizeof(std::uint64_t); }
+
+private:
+    int rowCount;
+    int colCount;
+    int rowWords;
+    std::vector<std::uint64_t> words;
+};
+
+} // namespace pathfinder
@@ -0,0 +1,355 @@
+#pragma once
+
+// Connected components of the open cells, so a query whose endpoints cannot
+// reach each other is rejected before it floods the start's whole region.
+//
+// Each open cell carries a label, and labels are joined in a union-find
+// forest: two cells are connected when their labels have the same root. The
+// first build labels the grid in one row-major pass. Afterwards update()
+// replays the grid's edit journal:
+//
+//   - A cell that opened gets a fresh label joined with its open neighbors.
+//   - A cell that closed can split its component. If its open neighbors are
+//     still linked through the eight cells around it and no side neighbor
+//     closed in the same batch, nothing split. Otherwise a search starts from
+//     each of those neighbors, all advancing one cell at a time. Searches
+//     that meet are on one piece, and once at most one piece of a component
+//     is still growing, every finished piece gets a label of its own while
+//     the unfinished one keeps the old label. A cut costs about the size of
+//     the smaller pieces rather than of the whole component.
+//
+// Cost edits do not change connectivity and are skipped.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "grid.hpp"
+
+namespace pathfinder {
+
+class ComponentMap {
+public:
+    explicit ComponentMap(const Grid& grid) { rebuild(grid); }
+
+    // The labels describe the grid as it was at the last build or update
+    bool current(const Grid& grid) const { return grid.version() == gridVersion && grid.cols() == cols; }
+
+    // Both cells are open and in the same component. A build leaves every
+    // label pointing straight at its root, and union by size keeps the trees
+    // that updates grow shallow, so this is a few array reads.
+    bool connected(int a, int b) const {
+        return labels[a] >= 0 && labels[b] >= 0 && root(labels[a]) == root(labels[b]);
+    }
+
+    // Brings the labels up to date with the grid's edits since the last
+    // build or update, rebuilding everything if the journal no longer
+    // reaches back that far. Returns the number of cells relabeled.
+    int update(const Grid& grid) {
+        std::vector<int> edited;
+        if (!grid.editsSince(gridVersion, edited) || grid.cols() != cols) {
+            rebuild(grid);
+            return grid.cellCount();
+        }
+        gridVersion = grid.version();
+
+        // Closures first, so the openings below never join through a cell
+        // that is about to close
+        std::vector<int> closed;
+        for (int index : edited) {
+            if (labels[index] >= 0 && !grid.passable(index)) {
+                labels[index] = CLOSING;
+                closed.push_back(index);
+            }
+        }
+        for (int index : edited) {
+            if (labels[index] < 0 && grid.passable(index)) {
+                labels[index] = newLabel();
+                // Neighbors opened later in the batch join when their turn comes
+                forEachOpenNeighbor(grid, index, [&](int neighbor) {
+                    if (labels[neighbor] >= 0) {
+                        unite(labels[index], labels[neighbor]);
+                    }
+                });
+            }
+        }
+
+        // Every piece a component can have been cut into touches a closure
+        // that may split it, so searching from their neighbors finds them
+        // all. A run of cells closed together can cut a corridor that no
+        // single one of them cuts on its own.
+        if (stampBase > INT_MAX - grid.cellCount()) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            stampBase = 1;
+        }
+        std::vector<int> seeds;
+        for (int index : closed) {
+            if (!maySplit(grid, index) && !closedBeside(grid, index)) {
+                continue;
+            }
+            forEachOpenNeighbor(grid, index, [&](int neighbor) {
+                if (stamps[neighbor] < stampBase) {
+                    stamps[neighbor] = stampBase + static_cast<int>(seeds.size());
+                    seeds.push_back(neighbor);
+                }
+            });
+        }
+        for (int index : closed) {
+            labels[index] = -1;
+        }
+        int relabeled = seeds.size() > 1 ? separate(grid, seeds) : 0;
+        stampBase += static_cast<int>(seeds.size());
+
+        // Abandoned labels pile up over many edits; start over once there are
+        // twice as many as cells
+        if (parents.size() > 2 * static_cast<size_t>(grid.cellCount()) + 1024) {
+            rebuild(grid);
+            return grid.cellCount();
+        }
+        return relabeled;
+    }
+
+    size_t memoryUsage() const {
+        return (labels.capacity() + parents.capacity() + sizes.capacity() + stamps.capacity()) * sizeof(int);
+    }
+
+private:
+    // Label of a cell closed by the update in progress
+    static const int CLOSING = -2;
+
+    std::uint32_t gridVersion = 0;
+    int cols = 0;
+    std::vector<int> labels;  // Per cell, negative for walls
+    std::vector<int> parents; // Union-find forest over labels
+    std::vector<int> sizes;   // Labels in each root's tree
+    // Cells reached by the searches of the current update hold stampBase
+    // plus the number of the search that reached them
+    std::vector<int> stamps;
+    int stampBase = 1;
+
+    int root(int label) const {
+        while (parents[label] != label) {
+            label = parents[label];
+        }
+        return label;
+    }
+
+    int find(int label) {
+        while (parents[label] != label) {
+            parents[label] = parents[parents[label]];
+            label = parents[label];
+        }
+        return label;
+    }
+
+    void unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return;
+        }
+        if (sizes[a] < sizes[b]) {
+            std::swap(a, b);
+        }
+        parents[b] = a;
+        sizes[a] += sizes[b];
+    }
+
+    int newLabel() {
+        int label = static_cast<int>(parents.size());
+        parents.push_back(label);
+        sizes.push_back(1);
+        return label;
+    }
+
+    template <typename Visit>
+    static void forEachOpenNeighbor(const Grid& grid, int index, Visit visit) {
+        Cell cell = grid.cellAt(index);
+        for (const Cell& delta : detail::DELTAS) {
+            Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            if (grid.contains(neighbor) && grid.passable(grid.index(neighbor))) {
+                visit(grid.index(neighbor));
+            }
+        }
+    }
+
+    // Two-pass labeling: every open cell joins its left and upper neighbors,
+    // then each label is pointed straight at its root
+    void rebuild(const Grid& grid) {
+        gridVersion = grid.version();
+        cols = grid.cols();
+        labels.assign(grid.cellCount(), -1);
+        parents.clear();
+        sizes.clear();
+        stamps.assign(grid.cellCount(), 0);
+        stampBase = 1;
+        for (int row = 0; row < grid.rows(); ++row) {
+            for (int col = 0; col < cols; ++col) {
+                int index = row * cols + col;
+                if (!grid.passable(index)) {
+                    continue;
+                }
+                bool left = col > 0 && labels[index - 1] >= 0;
+                bool up = row > 0 && labels[index - cols] >= 0;
+                if (left) {
+                    labels[index] = labels[index - 1];
+                    if (up) {
+                        unite(labels[index], labels[index - cols]);
+                    }
+                } else if (up) {
+                    labels[index] = labels[index - cols];
+                } else {
+                    labels[index] = newLabel();
+                }
+            }
+        }
+        for (size_t label = 0; label < parents.size(); ++label) {
+            parents[label] = find(static_cast<int>(label));
+        }
+    }
+
+    // The ring of eight cells around a closed cell, in order, splits into
+    // arcs of open cells. The closed cell's open neighbors stay connected if
+    // they all lie on one arc.
+    static bool maySplit(const Grid& grid, int index) {
+        static const Cell RING[8] = {{-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}};
+        Cell cell = grid.cellAt(index);
+        bool openRing[8];
+        for (int i = 0; i < 8; ++i) {
+            Cell neighbor{cell.row + RING[i].row, cell.col + RING[i].col};
+            openRing[i] = grid.contains(neighbor) && grid.passable(grid.index(neighbor));
+        }
+        // Count the arcs that hold at least one side neighbor (even slots)
+        int arcs = 0;
+        for (int start = 0; start < 8; ++start) {
+            if (!openRing[start] || openRing[(start + 7) % 8]) {
+                continue; // Not the first cell of an arc
+            }
+            bool hasSide = false;
+            for (int i = start; openRing[i % 8] && i < start + 8; ++i) {
+                hasSide = hasSide || i % 2 == 0;
+            }
+            arcs += hasSide ? 1 : 0;
+        }
+        // No arc at all means the ring is either all walls or all open
+        return arcs > 1;
+    }
+
+    bool closedBeside(const Grid& grid, int index) const {
+        Cell cell = grid.cellAt(index);
+        for (const Cell& delta : detail::DELTAS) {
+            Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            if (grid.contains(neighbor) && labels[grid.index(neighbor)] == CLOSING) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs one search per seed in lockstep and relabels the pieces that turn
+    // out to be cut off. Seeds whose labels share a root started in one
+    // component; seeds from different components never meet. Returns the
+    // number of cells relabeled.
+    int separate(const Grid& grid, const std::vector<int>& seeds) {
+        int count = static_cast<int>(seeds.size());
+        std::vector<std::vector<int>> reached(count);
+        std::vector<size_t> heads(count, 0);
+        // Searches that met form a group; each group counts its searches
+        // that can still grow
+        std::vector<int> groups(count);
+        std::vector<int> growing(count, 1);
+        // Each component is represented by one of its seeds, which holds the
+        // component's count of groups and of groups still growing
+        std::vector<int> family(count);
+        std::vector<int> familyGroups(count, 0);
+        std::vector<int> familyGrowing(count, 0);
+        std::vector<std::pair<int, int>> byRoot;
+        for (int i = 0; i < count; ++i) {
+            reached[i].push_back(seeds[i]);
+            groups[i] = i;
+            byRoot.emplace_back(find(labels[seeds[i]]), i);
+        }
+        std::sort(byRoot.begin(), byRoot.end());
+        for (int k = 0; k < count; ++k) {
+            int i = byRoot[k].second;
+            family[i] = k > 0 && byRoot[k - 1].first == byRoot[k].first ? family[byRoot[k - 1].second] : i;
+            ++familyGroups[family[i]];
+            ++familyGrowing[family[i]];
+        }
+        auto group = [&](int search) {
+            while (groups[search] != search) {
+                search = groups[search] = groups[groups[search]];
+            }
+            return search;
+        };
+        // A component is settled once at most one of its pieces still grows:
+        // that piece holds everything the others did not reach
+        auto settled = [&](int search) {
+            return familyGroups[family[search]] < 2 || familyGrowing[family[search]] < 2;
+        };
+
+        bool active = true;
+        while (active) {
+            active = false;
+            for (int i = 0; i < count; ++i) {
+                if (heads[i] == reached[i].size() || settled(i)) {
+                    continue;
+                }
+                active = true;
+                int current = reached[i][heads[i]++];
+                forEachOpenNeighbor(grid, current, [&](int neighbor) {
+                    if (stamps[neighbor] < stampBase) {
+                        stamps[neighbor] = stampBase + i;
+                        reached[i].push_back(neighbor);
+                        return;
+                    }
+                    int a = group(i);
+                    int b = group(stamps[neighbor] - stampBase);
+                    if (a != b) {
+                        groups[b] = a;
+                        --familyGroups[family[i]];
+                        if (growing[b] > 0) {
+                            --familyGrowing[family[i]];
+                        }
+                        growing[a] += growing[b];
+                    }
+                });
+                if (heads[i] == reached[i].size() && --growing[group(i)] == 0) {
+                    --familyGrowing[family[i]];
+                }
+            }
+        }
+
+        // In each split component, the piece still growing (or the first
+        // one, if all finished) keeps the old label; every other piece gets
+        // a new one
+        std::vector<int> kept(count, -1);
+        for (int i = 0; i < count; ++i) {
+            int a = group(i);
+            int f = family[i];
+            if (familyGroups[f] > 1 && kept[f] < 0 && (growing[a] > 0 || familyGrowing[f] == 0)) {
+                kept[f] = a;
+            }
+        }
+        int relabeled = 0;
+        std::vector<int> newLabels(count, -1);
+        for (int i = 0; i < count; ++i) {
+            int a = group(i);
+            if (familyGroups[family[i]] < 2 || kept[family[i]] == a) {
+                continue;
+            }
+            if (newLabels[a] < 0) {
+                newLabels[a] = newLabel();
+            }
+            for (int cell : reached[i]) {
+                labels[cell] = newLabels[a];
+            }
+            relabeled += static_cast<int>(reached[i].size());
+        }
+        return relabeled;
+    }
+};
+
+} // namespace pathfinder
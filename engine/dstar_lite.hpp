@@ -0,0 +1,284 @@
+#pragma once
+
+// D* Lite (Koenig and Likhachev): incremental replanning for a moving start.
+// The search runs backwards from the goal, so g(cell) is the cost of the
+// cheapest known path from the cell to the goal, and rhs(cell) is the one
+// step lookahead min over neighbors of (step cost + g(neighbor)). A cell is
+// consistent when both agree. After grid edits only the cells whose rhs
+// changed are made inconsistent again, and the next search repairs just the
+// part of the tree they affect instead of starting over.
+//
+// Moving the start (a robot walking the path) shifts every heuristic value;
+// instead of re-keying the queue, the offset km grows by the distance moved.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "grid.hpp"
+#include "open_list.hpp"
+#include "search_space.hpp"
+#include "stats.hpp"
+
+namespace pathfinder {
+
+class DStarLite {
+public:
+    static constexpr int INFINITE = SearchSpace::UNREACHED;
+
+    DStarLite(const Grid& grid, const Cell& start, const Cell& goal)
+        : grid(grid), gridVersion(grid.version()), start(start), goal(goal), lastStart(start), km(0),
+          g(grid.cellCount()), rhs(grid.cellCount()), queuedKey(grid.cellCount()), stamp(grid.cellCount(), 0) {
+        updateRhs(grid.index(goal));
+    }
+
+    // Starts over on a new query, keeping the buffers. Bumping the generation
+    // forgets every cell at once, so this costs O(1) however big the map is.
+    void restart(const Cell& newStart, const Cell& newGoal) {
+        gridVersion = grid.version();
+        start = newStart;
+        goal = newGoal;
+        lastStart = newStart;
+        km = 0;
+        if (++generation == 0) {
+            // The counter wrapped around, old stamps could look current again
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        queue.clear();
+        counters = SearchStats();
+        updateRhs(grid.index(goal));
+    }
+
+    bool plansOn(const Grid& other) const { return &grid == &other; }
+
+    const Cell& startCell() const { return start; }
+    const SearchStats& stats() const { return counters; }
+    void resetStats() { counters = SearchStats(); }
+
+    // Processes one inconsistent cell and returns its index, or -1 once the
+    // start is consistent and no queued cell can still improve it
+    int step() {
+        int startIndex = grid.index(start);
+        if (!grid.passable(startIndex)) {
+            return -1; // Nothing to repair until the start is cleared again
+        }
+        while (!queue.empty()) {
+            std::uint64_t oldKey = queue.topKey();
+            int u = queue.topIndex();
+            if (queuedKey[u] != oldKey) { // Queued cells are always current
+                queue.pop(); // Superseded by a later push or no longer queued
+                if (STATS_ENABLED) {
+                    ++counters.stalePops;
+                }
+                continue;
+            }
+            if (oldKey >= calculateKey(startIndex) && rhsOf(startIndex) == gOf(startIndex)) {
+                return -1;
+            }
+            queue.pop();
+            queuedKey[u] = NOT_QUEUED;
+
+            std::uint64_t newKey = calculateKey(u);
+            if (oldKey < newKey) {
+                // Its key went stale when the start moved
+                enqueue(u);
+            } else if (g[u] > rhs[u]) {
+                // Overconsistent: settle it and offer it to its neighbors
+                g[u] = rhs[u];
+                forEachNeighbor(u, [&](int s) {
+                    int cost = stepCost(s, u);
+                    touch(s);
+                    if (cost != INFINITE && s != grid.index(goal)) {
+                        rhs[s] = std::min(rhs[s], cost + g[u]);
+                    }
+                    updateVertex(s);
+                });
+            } else {
+                // Underconsistent: its old value is gone, so neighbors that
+                // relied on it look for another way
+                g[u] = INFINITE;
+                if (STATS_ENABLED) {
+                    ++counters.reopenings;
+                }
+                updateRhs(u);
+                forEachNeighbor(u, [&](int s) { updateRhs(s); });
+            }
+            return u;
+        }
+        return -1;
+    }
+
+    // Pulls the grid's edits since the last call and reopens every cell whose
+    // lookahead they changed. Returns the number of edited cells.
+    int update() {
+        std::vector<int> edited;
+        if (!grid.editsSince(gridVersion, edited)) {
+            // The journal was trimmed; fall back to checking every cell
+            edited.clear();
+            for (int i = 0; i < grid.cellCount(); ++i) {
+                edited.push_back(i);
+            }
+        }
+        gridVersion = grid.version();
+        // An edited cell changes the cost of stepping into it and whether
+        // anything can step out of it, which affects it and its neighbors
+        for (int index : edited) {
+            updateRhs(index);
+            forEachNeighbor(index, [&](int s) { updateRhs(s); });
+        }
+        return static_cast<int>(edited.size());
+    }
+
+    void moveStart(const Cell& newStart) {
+        km += detail::manhattan(lastStart, newStart);
+        lastStart = newStart;
+        start = newStart;
+    }
+
+    // Cheapest cost from the start to the goal, or INFINITE
+    int distance() const { return gOf(grid.index(start)); }
+
+    // Follows the cheapest neighbor from the start to the goal. Only
+    // meaningful once step() has returned -1.
+    bool extractPath(std::vector<Cell>& path, int& cost) const {
+        path.clear();
+        cost = 0;
+        int current = grid.index(start);
+        int goalIndex = grid.index(goal);
+        if (gOf(current) == INFINITE || !grid.passable(current)) {
+            return false;
+        }
+        path.push_back(start);
+        while (current != goalIndex) {
+            int best = -1;
+            long long bestCost = INFINITE;
+            forEachNeighbor(current, [&](int s) {
+                int step = stepCost(current, s);
+                int next = gOf(s);
+                if (step != INFINITE && next != INFINITE && static_cast<long long>(step) + next < bestCost) {
+                    bestCost = static_cast<long long>(step) + next;
+                    best = s;
+                }
+            });
+            if (best < 0 || static_cast<int>(path.size()) > grid.cellCount()) {
+                return false;
+            }
+            cost += grid.cost(best);
+            current = best;
+            path.push_back(grid.cellAt(current));
+        }
+        return true;
+    }
+
+    size_t memoryUsage() const {
+        return (g.capacity() + rhs.capacity()) * sizeof(int) + queuedKey.capacity() * sizeof(std::uint64_t) +
+               stamp.capacity() * sizeof(std::uint32_t) + queue.memoryUsage();
+    }
+
+private:
+    static constexpr std::uint64_t NOT_QUEUED = ~static_cast<std::uint64_t>(0);
+
+    const Grid& grid;
+    std::uint32_t gridVersion;
+    Cell start;
+    Cell goal;
+    Cell lastStart;
+    int km;
+    std::vector<int> g;
+    std::vector<int> rhs;
+    // Key of a cell's live queue entry. The heap has no decrease-key or
+    // remove, so entries whose key no longer matches are skipped when popped.
+    std::vector<std::uint64_t> queuedKey;
+    // A cell's g, rhs and queued key belong to the current query only when
+    // its stamp matches the generation; otherwise it reads as untouched
+    std::vector<std::uint32_t> stamp;
+    std::uint32_t generation = 1;
+    QuaternaryHeap queue;
+    SearchStats counters;
+
+    int gOf(int index) const { return stamp[index] == generation ? g[index] : INFINITE; }
+    int rhsOf(int index) const { return stamp[index] == generation ? rhs[index] : INFINITE; }
+
+    // Brings a cell into the current query before it is written
+    void touch(int index) {
+        if (stamp[index] != generation) {
+            stamp[index] = generation;
+            g[index] = INFINITE;
+            rhs[index] = INFINITE;
+            queuedKey[index] = NOT_QUEUED;
+        }
+    }
+
+    // Orders on min(g, rhs) + h + km, then on min(g, rhs)
+    std::uint64_t calculateKey(int index) const {
+        int best = std::min(gOf(index), rhsOf(index));
+        if (best == INFINITE) {
+            return NOT_QUEUED;
+        }
+        int primary = best + detail::manhattan(start, grid.cellAt(index)) + km;
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(primary)) << 32) |
+               static_cast<std::uint32_t>(best);
+    }
+
+    // Stepping into a cell costs that cell's cost; walls can be neither
+    // entered nor left
+    int stepCost(int from, int to) const {
+        if (!grid.passable(from) || !grid.passable(to)) {
+            return INFINITE;
+        }
+        return grid.cost(to);
+    }
+
+    template <typename Visit>
+    void forEachNeighbor(int index, Visit visit) const {
+        Cell cell = grid.cellAt(index);
+        for (const Cell& delta : detail::DELTAS) {
+            Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            if (grid.contains(neighbor)) {
+                visit(grid.index(neighbor));
+            }
+        }
+    }
+
+    void updateRhs(int index) {
+        touch(index);
+        if (index != grid.index(goal)) {
+            int best = INFINITE;
+            forEachNeighbor(index, [&](int s) {
+                int cost = stepCost(index, s);
+                int next = gOf(s);
+                if (cost != INFINITE && next != INFINITE) {
+                    best = std::min(best, cost + next);
+                }
+            });
+            rhs[index] = best;
+        } else {
+            rhs[index] = grid.passable(index) ? 0 : INFINITE;
+        }
+        updateVertex(index);
+    }
+
+    // The cell must be current (see touch())
+    void updateVertex(int index) {
+        if (g[index] != rhs[index]) {
+            enqueue(index);
+        } else {
+            queuedKey[index] = NOT_QUEUED;
+        }
+    }
+
+    void enqueue(int index) {
+        std::uint64_t key = calculateKey(index);
+        if (queuedKey[index] != key) {
+            queuedKey[index] = key;
+            queue.push(key, index);
+            if (STATS_ENABLED) {
+                ++counters.pushes;
+                counters.maxOpenSize = std::max(counters.maxOpenSize, static_cast<int>(queue.size()));
+            }
+        }
+    }
+};
+
+} // namespace pathfinder
@@ -0,0 +1,211 @@
+#pragma once
+
+// One-to-all searches. A FlowField runs a single Dijkstra from a goal over
+// the whole grid and keeps, for every cell, the direction of its next step
+// towards the goal and the remaining distance. Any number of agents heading
+// for that goal then move by looking up their own cell, one array read per
+// step, instead of each searching for a path of its own.
+//
+// The search runs backwards from the goal: a path pays for the cells it
+// enters, so walking one backwards pays for the cell it came from. Costs and
+// corner rules are those of the forward searches with the same Movement, so
+// following the field from a cell walks a path exactly as cheap as the one
+// A* finds. Uniform-cost four-connected fields are built breadth-first.
+//
+// Distances are in the Movement's distance units: cells for four-connected
+// movement, DISTANCE_UNIT per side step for eight-connected. Any-angle
+// searches have no field of their own; a field with eight-connected
+// movement serves them.
+//
+// On very large maps a field can be built on a ThreadPool instead (see
+// parallel_flood.hpp); the distances are the same.
+//
+// A field describes the grid as it was built; rebuild it after edits.
+
+#include <cstdint>
+#include <vector>
+
+#include "grid.hpp"
+#include "movement.hpp"
+#include "open_list.hpp"
+#include "parallel_flood.hpp"
+#include "search_space.hpp"
+#include "thread_pool.hpp"
+
+namespace pathfinder {
+
+namespace detail {
+
+// Buffers for flood(), kept by callers that run one flood after another
+struct FloodBuffers {
+    SearchSpace space;
+    std::vector<int> queue;
+    QuaternaryHeap heap;
+};
+
+// Dijkstra from root over the open cells, calling settle(index) as each cell
+// gets its final distance in space, in cost order. Distances are of paths
+// from root or, with toRoot, of paths ending at root; a cell's parent is its
+// neighbor one step closer to root. Stops early once settle returns false.
+template <typename Settle>
+void flood(const Grid& grid, int root, const Movement& movement, bool toRoot, FloodBuffers& buffers, Settle settle) {
+    SearchSpace& space = buffers.space;
+    space.resize(grid.cellCount());
+    space.reset();
+    buffers.queue.clear();
+    buffers.heap.clear();
+    if (!grid.passable(root)) {
+        return;
+    }
+    bool eightWays = movement.connectivity == Connectivity::Eight;
+    bool fifo = !eightWays && grid.uniformCost();
+    int moves = eightWays ? 8 : 4;
+    int sideLength = eightWays ? DISTANCE_UNIT : 1;
+    size_t head = 0;
+    space.open(root, 0, -1);
+    if (fifo) {
+        buffers.queue.push_back(root);
+    } else {
+        buffers.heap.push(priorityKey(0), root);
+    }
+    while (fifo ? head < buffers.queue.size() : !buffers.heap.empty()) {
+        int current = fifo ? buffers.queue[head++] : buffers.heap.pop();
+        if (space.closed(current)) {
+            continue; // Stale heap entry
+        }
+        space.close(current);
+        if (!settle(current)) {
+            return;
+        }
+        Cell cell = grid.cellAt(current);
+        int distance = space.g(current);
+        for (int move = 0; move < moves; ++move) {
+            const Cell& delta = MOVES[move];
+            Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            bool diagonal = move >= 4;
+            if (!grid.contains(neighbor) || (diagonal && !diagonalAllowed(grid, cell, delta, movement.corners))) {
+                continue;
+            }
+            int next = current + delta.row * grid.cols() + delta.col;
+            if (!grid.passable(next) || space.closed(next)) {
+                continue;
+            }
+            int length = diagonal ? DIAGONAL_STEP : sideLength;
+            int newDistance = distance + grid.cost(toRoot ? current : next) * length;
+            if (newDistance < space.g(next)) {
+                space.open(next, newDistance, current);
+                if (fifo) {
+                    buffers.queue.push_back(next);
+                } else {
+                    buffers.heap.push(priorityKey(newDistance), next);
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+class FlowField {
+public:
+    // No direction: the goal itself, walls and cells that cannot reach it
+    static constexpr std::int8_t NONE = -1;
+
+    FlowField(const Grid& grid, const Cell& goal, const Movement& movement = Movement())
+        : goalCell(goal), cols(grid.cols()), gridVersion(grid.version()), directions(grid.cellCount(), NONE),
+          distances(grid.cellCount(), SearchSpace::UNREACHED) {
+        detail::FloodBuffers buffers;
+        detail::flood(grid, grid.index(goal), movement, true, buffers, [&](int index) {
+            distances[index] = buffers.space.g(index);
+            int parent = buffers.space.parent(index);
+            if (parent >= 0) {
+                directions[index] = moveTowards(index, parent);
+            }
+            return true;
+        });
+    }
+
+    // The same field built on the pool. Where a cell has several equally
+    // cheap first steps it may point along another one than a serial build.
+    FlowField(const Grid& grid, const Cell& goal, const Movement& movement, ThreadPool& pool)
+        : goalCell(goal), cols(grid.cols()), gridVersion(grid.version()), directions(grid.cellCount(), NONE),
+          distances(parallelFlood(grid, grid.index(goal), movement, true, pool)) {
+        int sideLength = movement.connectivity == Connectivity::Eight ? DISTANCE_UNIT : 1;
+        int moves = movement.connectivity == Connectivity::Eight ? 8 : 4;
+        // A cell's first step goes to a neighbor whose distance plus the step
+        // makes up its own
+        pool.parallelFor(grid.rows(), 1, [&](int begin, int end, int) {
+            for (int index = begin * cols; index < end * cols; ++index) {
+                if (distances[index] == SearchSpace::UNREACHED || distances[index] == 0) {
+                    continue;
+                }
+                Cell cell = grid.cellAt(index);
+                for (int move = 0; move < moves; ++move) {
+                    const Cell& delta = detail::MOVES[move];
+                    Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+                    bool diagonal = move >= 4;
+                    if (!grid.contains(neighbor) ||
+                        (diagonal && !detail::diagonalAllowed(grid, cell, delta, movement.corners))) {
+                        continue;
+                    }
+                    int next = grid.index(neighbor);
+                    int length = diagonal ? DIAGONAL_STEP : sideLength;
+                    if (distances[next] != SearchSpace::UNREACHED && grid.passable(next) &&
+                        distances[next] + grid.cost(next) * length == distances[index]) {
+                        directions[index] = static_cast<std::int8_t>(move);
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    // The field describes the grid as it is now
+    bool current(const Grid& grid) const { return grid.version() == gridVersion && grid.cols() == cols; }
+
+    const Cell& goal() const { return goalCell; }
+
+    bool reachable(const Cell& cell) const { return distances[index(cell)] != SearchSpace::UNREACHED; }
+
+    // Remaining distance to the goal, SearchSpace::UNREACHED if there is no way
+    int distance(const Cell& cell) const { return distances[index(cell)]; }
+
+    // Index into detail::MOVES of the first step towards the goal, or NONE
+    int direction(const Cell& cell) const { return directions[index(cell)]; }
+
+    // The cell to step to from the given one; the cell itself at the goal or
+    // where the goal is out of reach
+    Cell next(const Cell& cell) const {
+        int move = directions[index(cell)];
+        if (move == NONE) {
+            return cell;
+        }
+        return Cell{cell.row + detail::MOVES[move].row, cell.col + detail::MOVES[move].col};
+    }
+
+    size_t memoryUsage() const {
+        return directions.capacity() * sizeof(std::int8_t) + distances.capacity() * sizeof(int);
+    }
+
+private:
+    Cell goalCell;
+    int cols;
+    std::uint32_t gridVersion;
+    std::vector<std::int8_t> directions;
+    std::vector<int> distances;
+
+    int index(const Cell& cell) const { return cell.row * cols + cell.col; }
+
+    std::int8_t moveTowards(int from, int to) const {
+        int dr = to / cols - from / cols;
+        int dc = to % cols - from % cols;
+        for (int move = 0; move < 8; ++move) {
+            if (detail::MOVES[move].row == dr && detail::MOVES[move].col == dc) {
+                return static_cast<std::int8_t>(move);
+            }
+        }
+        return NONE;
+    }
+};
+
+} // namespace pathfinder
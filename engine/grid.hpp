@@ -0,0 +1,224 @@
+#pragma once
+
+// Grid model shared by the headless search engine and the SFML visualizer.
+// Nothing in the engine/ directory depends on SFML.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace pathfinder {
+
+struct Cell {
+    int row = 0;
+    int col = 0;
+};
+
+inline bool operator==(const Cell& a, const Cell& b) {
+    return a.row == b.row && a.col == b.col;
+}
+
+inline bool operator!=(const Cell& a, const Cell& b) {
+    return !(a == b);
+}
+
+namespace detail {
+
+// Define the deltas for moving in four directions: left, right, up, and down
+constexpr Cell DELTAS[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+inline int manhattan(const Cell& a, const Cell& b) {
+    return std::abs(a.row - b.row) + std::abs(a.col - b.col);
+}
+
+} // namespace detail
+
+// Layers a grid did not allocate itself, such as a mapped map file (see
+// grid_file.hpp). The grid keeps owner alive and writes edits straight into
+// the layers, so the memory must be private to it; a copy-on-write mapping is.
+struct ExternalLayers {
+    std::shared_ptr<void> owner;
+    std::uint64_t* passableWords = nullptr;
+    std::uint8_t* costs = nullptr; // nullptr when every cell costs 1
+    int weightedCells = 0;
+};
+
+// Static map data, stored row-major as one flat buffer per layer so a search
+// touching neighboring cells stays within the same few cache lines. The size is
+// chosen at runtime and may be non-square; flat indices are ints, which covers
+// maps of up to about two billion cells.
+//
+// Passability takes one bit per cell, bit i % 64 of word i / 64. The cost
+// layer takes a byte per cell and is only allocated once some cell costs
+// more than 1, so a plain maze needs an eighth of a byte per cell.
+class Grid {
+public:
+    Grid(int rows, int cols)
+        : rowCount(checkedDimension(rows)), colCount(checkedDimension(cols)),
+          ownedPassable(wordCount(checkedCellCount(rows, cols)), ~static_cast<std::uint64_t>(0)) {
+        // Bits past the last cell stay clear
+        if (cellCount() % 64 != 0) {
+            ownedPassable.back() = (static_cast<std::uint64_t>(1) << (cellCount() % 64)) - 1;
+        }
+        passableWords = ownedPassable.data();
+    }
+
+    // Uses the given layers in place; nothing is copied
+    Grid(int rows, int cols, ExternalLayers layers)
+        : rowCount(checkedDimension(rows)), colCount(checkedDimension(cols)), external(std::move(layers.owner)),
+          passableWords(layers.passableWords), costs(layers.costs), weightedCells(layers.weightedCells) {
+        checkedCellCount(rows, cols);
+    }
+
+    // A copy owns its layers, even when the original uses external ones
+    Grid(const Grid& other)
+        : rowCount(other.rowCount), colCount(other.colCount),
+          ownedPassable(other.passableWords, other.passableWords + wordCount(other.cellCount())),
+          passableWords(ownedPassable.data()), weightedCells(other.weightedCells), editVersion(other.editVersion),
+          journal(other.journal), journalStart(other.journalStart) {
+        if (other.costs) {
+            ownedCosts.assign(other.costs, other.costs + other.cellCount());
+            costs = ownedCosts.data();
+        }
+    }
+
+    // Moving a vector keeps its buffer, so the layer pointers stay valid
+    Grid(Grid&&) = default;
+    Grid& operator=(Grid&&) = default;
+    Grid& operator=(const Grid& other) { return *this = Grid(other); }
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    int cellCount() const { return rowCount * colCount; }
+
+    bool contains(const Cell& cell) const {
+        return cell.row >= 0 && cell.row < rowCount && cell.col >= 0 && cell.col < colCount;
+    }
+
+    // Cells are addressed row-major; searches work on these flat indices
+    int index(const Cell& cell) const { return cell.row * colCount + cell.col; }
+    Cell cellAt(int index) const { return Cell{index / colCount, index % colCount}; }
+
+    // Walls are impassable. Every other cell has a traversal cost from 1 to
+    // MAX_COST, paid when a path steps into it.
+    static constexpr int MAX_COST = 255;
+
+    bool passable(int index) const { return (passableWords[index >> 6] >> (index & 63)) & 1; }
+    int cost(int index) const { return costs ? costs[index] : 1; }
+
+    // True while every cell costs 1, which lets Dijkstra run as a plain BFS
+    bool uniformCost() const { return weightedCells == 0; }
+    int weightedCellCount() const { return weightedCells; }
+
+    // The raw layers, for writing the grid out: (cellCount() + 63) / 64
+    // passability words, and cellCount() cost bytes or nullptr if no cost
+    // layer was ever needed
+    const std::uint64_t* passabilityWords() const { return passableWords; }
+    const std::uint8_t* costBytes() const { return costs; }
+
+    // Bumped by every edit that changes a cell, so anything precomputed from
+    // the grid can tell whether it is still current
+    std::uint32_t version() const { return editVersion; }
+
+    // Appends the indices of the cells edited since the given version, oldest
+    // first (a cell edited twice appears twice). Returns false when the
+    // journal no longer reaches back that far; the caller must then treat
+    // every cell as changed.
+    bool editsSince(std::uint32_t version, std::vector<int>& cells) const {
+        if (version < journalStart || version > editVersion) {
+            return false;
+        }
+        cells.insert(cells.end(), journal.begin() + (version - journalStart), journal.end());
+        return true;
+    }
+
+    // Edits touch only the given cells, so painting strokes or loading a map
+    // costs O(changed cells) and never rebuilds the grid
+    void setCell(const Cell& cell, bool passable, int cost = 1) {
+        if (cost < 1 || cost > MAX_COST) {
+            throw std::invalid_argument("cell cost must be between 1 and Grid::MAX_COST");
+        }
+        int i = index(cell);
+        if (this->passable(i) == passable && this->cost(i) == cost) {
+            return;
+        }
+        if (!costs && cost != 1) {
+            ownedCosts.assign(cellCount(), 1);
+            costs = ownedCosts.data();
+        }
+        weightedCells += (cost != 1) - (this->cost(i) != 1);
+        std::uint64_t bit = static_cast<std::uint64_t>(1) << (i & 63);
+        if (passable) {
+            passableWords[i >> 6] |= bit;
+        } else {
+            passableWords[i >> 6] &= ~bit;
+        }
+        if (costs) {
+            costs[i] = static_cast<std::uint8_t>(cost);
+        }
+        ++editVersion;
+        record(i);
+    }
+
+    // Sets every cell of the rectangle spanned by two corners, clipped to the grid
+    void fill(const Cell& corner, const Cell& oppositeCorner, bool passable, int cost = 1) {
+        int top = std::max(0, std::min(corner.row, oppositeCorner.row));
+        int bottom = std::min(rowCount - 1, std::max(corner.row, oppositeCorner.row));
+        int left = std::max(0, std::min(corner.col, oppositeCorner.col));
+        int right = std::min(colCount - 1, std::max(corner.col, oppositeCorner.col));
+        for (int row = top; row <= bottom; ++row) {
+            for (int col = left; col <= right; ++col) {
+                setCell(Cell{row, col}, passable, cost);
+            }
+        }
+    }
+
+private:
+    int rowCount;
+    int colCount;
+    // Storage for the layers when the grid allocated them itself
+    std::vector<std::uint64_t> ownedPassable;
+    std::vector<std::uint8_t> ownedCosts;
+    std::shared_ptr<void> external;
+    std::uint64_t* passableWords = nullptr;
+    std::uint8_t* costs = nullptr;
+    int weightedCells = 0;
+    std::uint32_t editVersion = 0;
+    // journal[k] is the cell changed by the edit that made version
+    // journalStart + k + 1
+    std::vector<int> journal;
+    std::uint32_t journalStart = 0;
+
+    void record(int index) {
+        // Once the journal outgrows the grid, replaying it costs more than
+        // starting over, so the older half is dropped
+        if (journal.size() >= std::max<size_t>(cellCount(), 1024)) {
+            size_t dropped = journal.size() / 2;
+            journal.erase(journal.begin(), journal.begin() + dropped);
+            journalStart += static_cast<std::uint32_t>(dropped);
+        }
+        journal.push_back(index);
+    }
+
+    static int checkedDimension(int size) {
+        if (size <= 0) {
+            throw std::invalid_argument("grid dimensions must be positive");
+        }
+        return size;
+    }
+
+    static size_t wordCount(size_t cells) { return (cells + 63) / 64; }
+
+    static size_t checkedCellCount(int rows, int cols) {
+        if (static_cast<long long>(rows) * cols > std::numeric_limits<int>::max()) {
+            throw std::invalid_argument("grid has too many cells to index");
+        }
+        return static_cast<size_t>(rows) * cols;
+    }
+};
+
+} // namespace pathfinder
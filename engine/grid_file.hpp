@@ -0,0 +1,251 @@
+#pragma once
+
+// Binary map files. A file is a 64-byte header followed by the grid's layers
+// exactly as Grid keeps them in memory:
+//
+//     offset            size                     contents
+//     0                 64                       GridFileHeader
+//     passableOffset    (cells + 63) / 64 * 8    passability bits, one per cell
+//     costOffset        cells                    cost bytes (only if costOffset != 0)
+//
+// Both layers start on a 64-byte boundary. Loading maps the file copy-on-write
+// and points the grid at the mapping, so opening a map costs a few system
+// calls whatever its size; pages are read from disk when a search first
+// touches them, and edits stay private to the process. Files are written in
+// the byte order of the machine that saves them and rejected elsewhere.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "grid.hpp"
+
+namespace pathfinder {
+
+const char GRID_FILE_MAGIC[8] = {'P', 'F', 'G', 'R', 'I', 'D', '\r', '\n'};
+const std::uint32_t GRID_FILE_BYTE_ORDER = 0x01020304;
+const std::uint32_t GRID_FILE_VERSION = 1;
+
+struct GridFileHeader {
+    char magic[8];
+    std::uint32_t byteOrder;     // GRID_FILE_BYTE_ORDER as the writer stored it
+    std::uint32_t version;
+    std::int32_t rows;
+    std::int32_t cols;
+    std::int64_t weightedCells;  // Cells costing more than 1
+    std::uint64_t passableOffset;
+    std::uint64_t costOffset;    // 0 when every cell costs 1
+    std::uint64_t reserved[2];
+};
+
+static_assert(sizeof(GridFileHeader) == 64, "grid file header must stay 64 bytes");
+
+namespace detail {
+
+inline std::uint64_t alignTo64(std::uint64_t offset) {
+    return (offset + 63) / 64 * 64;
+}
+
+// A whole file mapped copy-on-write: writes go to private pages and never
+// reach the file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("cannot open map file " + path);
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        byteCount = static_cast<size_t>(fileSize.QuadPart);
+        HANDLE mapping = byteCount ? CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) : nullptr;
+        CloseHandle(file);
+        if (mapping) {
+            bytes = static_cast<std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        if (!bytes) {
+            throw std::runtime_error("cannot map map file " + path);
+        }
+#else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+            throw std::runtime_error("cannot open map file " + path);
+        }
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size == 0) {
+            close(file);
+            throw std::runtime_error("cannot map map file " + path);
+        }
+        byteCount = static_cast<size_t>(status.st_size);
+        int flags = MAP_PRIVATE;
+#ifdef MAP_NORESERVE
+        // Only the pages an edit copies need backing, not the whole file
+        flags |= MAP_NORESERVE;
+#endif
+        void* address = mmap(nullptr, byteCount, PROT_READ | PROT_WRITE, flags, file, 0);
+        close(file); // The mapping keeps its own reference
+        if (address == MAP_FAILED) {
+            throw std::runtime_error("cannot map map file " + path);
+        }
+        bytes = static_cast<std::uint8_t*>(address);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+#else
+        munmap(bytes, byteCount);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::uint8_t* data() const { return bytes; }
+    size_t size() const { return byteCount; }
+
+private:
+    std::uint8_t* bytes = nullptr;
+    size_t byteCount = 0;
+};
+
+// Cells whose cost is not 1, or cells + 1 if any cost is 0. Branch-free so
+// the loop vectorizes; this runs over every byte of a weighted map on load.
+inline std::uint64_t countWeightedCells(const std::uint8_t* costs, std::uint64_t cells) {
+    std::uint64_t weighted = 0;
+    std::uint64_t zero = 0;
+    for (std::uint64_t i = 0; i < cells; ++i) {
+        weighted += costs[i] != 1;
+        zero |= costs[i] == 0;
+    }
+    return zero ? cells + 1 : weighted;
+}
+
+} // namespace detail
+
+// Opens a map written by saveGridFile(). The grid uses the mapping in place.
+// Throws std::runtime_error if the file cannot be mapped or is not a valid
+// grid file: the header, layer offsets, padding bits and cost layer are
+// checked, while the passability bits of real cells can hold anything and
+// are taken as they are. A file changed by another process after loading
+// may show through in pages the grid has not edited yet.
+inline Grid loadGridFile(const std::string& path) {
+    std::shared_ptr<detail::MappedFile> file = std::make_shared<detail::MappedFile>(path);
+    if (file->size() < sizeof(GridFileHeader)) {
+        throw std::runtime_error(path + " is too short to be a grid file");
+    }
+    GridFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, GRID_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error(path + " is not a grid file");
+    }
+    if (header.byteOrder != GRID_FILE_BYTE_ORDER) {
+        throw std::runtime_error(path + " was written on a machine with a different byte order");
+    }
+    if (header.version != GRID_FILE_VERSION) {
+        throw std::runtime_error(path + " has unsupported grid file version " + std::to_string(header.version));
+    }
+    if (header.rows <= 0 || header.cols <= 0 ||
+        static_cast<long long>(header.rows) * header.cols > std::numeric_limits<int>::max()) {
+        throw std::runtime_error(path + " has invalid dimensions");
+    }
+    std::uint64_t cells = static_cast<std::uint64_t>(header.rows) * header.cols;
+    std::uint64_t passableBytes = (cells + 63) / 64 * 8;
+    if (header.passableOffset % 64 != 0 || header.passableOffset < sizeof(header) ||
+        header.passableOffset > file->size() || file->size() - header.passableOffset < passableBytes) {
+        throw std::runtime_error(path + " is truncated or has a bad passability layer offset");
+    }
+    if (header.costOffset != 0 && (header.costOffset > file->size() || file->size() - header.costOffset < cells)) {
+        throw std::runtime_error(path + " is truncated or has a bad cost layer offset");
+    }
+    if (header.weightedCells < 0 || static_cast<std::uint64_t>(header.weightedCells) > cells ||
+        (header.costOffset == 0 && header.weightedCells != 0)) {
+        throw std::runtime_error(path + " has an invalid weighted cell count");
+    }
+
+    ExternalLayers layers;
+    layers.passableWords = reinterpret_cast<std::uint64_t*>(file->data() + header.passableOffset);
+    layers.costs = header.costOffset ? file->data() + header.costOffset : nullptr;
+    // Searches read the bits past the last cell as walls
+    if (cells % 64 != 0 && layers.passableWords[cells / 64] >> (cells % 64) != 0) {
+        throw std::runtime_error(path + " has passable bits past the last cell");
+    }
+    // The header's count decides whether the grid is uniform-cost, which picks
+    // JPS, JPS+ and the FIFO Dijkstra queue, so a wrong count or a cost of 0
+    // would give wrong paths rather than an error. Checking means reading the
+    // whole cost layer once; uniform maps stay untouched until searched.
+    if (layers.costs) {
+        if (detail::countWeightedCells(layers.costs, cells) != static_cast<std::uint64_t>(header.weightedCells)) {
+            throw std::runtime_error(path + " has a cost of 0 or a weighted cell count that does not match its costs");
+        }
+    }
+    layers.weightedCells = static_cast<int>(header.weightedCells);
+    layers.owner = std::move(file);
+    return Grid(header.rows, header.cols, std::move(layers));
+}
+
+// Writes the grid in the format loadGridFile() reads; the cost layer is left
+// out of uniform-cost grids. The file is written next to the target and
+// renamed over it, so a grid currently mapped from the target stays valid.
+// Throws std::runtime_error on I/O failure.
+inline void saveGridFile(const Grid& grid, const std::string& path) {
+    std::uint64_t cells = static_cast<std::uint64_t>(grid.cellCount());
+    std::uint64_t passableBytes = (cells + 63) / 64 * 8;
+
+    GridFileHeader header = {};
+    std::memcpy(header.magic, GRID_FILE_MAGIC, sizeof(header.magic));
+    header.byteOrder = GRID_FILE_BYTE_ORDER;
+    header.version = GRID_FILE_VERSION;
+    header.rows = grid.rows();
+    header.cols = grid.cols();
+    header.weightedCells = grid.weightedCellCount();
+    header.passableOffset = sizeof(header);
+    header.costOffset = grid.uniformCost() ? 0 : detail::alignTo64(header.passableOffset + passableBytes);
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("cannot create " + temporary);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(grid.passabilityWords()), static_cast<std::streamsize>(passableBytes));
+        if (header.costOffset != 0) {
+            static const char padding[64] = {};
+            out.write(padding, static_cast<std::streamsize>(header.costOffset - header.passableOffset - passableBytes));
+            out.write(reinterpret_cast<const char*>(grid.costBytes()), static_cast<std::streamsize>(cells));
+        }
+        if (!out.flush()) {
+            throw std::runtime_error("cannot write " + temporary);
+        }
+    }
+    // Windows will not rename over an existing file
+    if (std::rename(temporary.c_str(), path.c_str()) != 0 &&
+        (std::remove(path.c_str()) != 0 || std::rename(temporary.c_str(), path.c_str()) != 0)) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("cannot replace " + path);
+    }
+}
+
+} // namespace pathfinder
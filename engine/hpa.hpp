@@ -0,0 +1,402 @@
+#pragma once
+
+// Hierarchical pathfinding (HPA*). The grid is cut into square clusters. Where
+// two neighboring clusters share an open stretch of border (an entrance), a
+// transition links a cell on each side; those cells become the nodes of a
+// small abstract graph. Inside each cluster every pair of nodes is linked by
+// the cost of the cheapest path that stays in the cluster.
+//
+// A query connects start and goal to the nodes of their clusters, searches
+// the abstract graph and then refines each abstract edge into grid cells with
+// a search confined to one cluster. Paths stay within a few percent of the
+// optimum, and the abstract search touches only a handful of nodes per
+// cluster crossed.
+//
+// The graph follows grid edits through Grid::editsSince(): only the clusters
+// whose cells or borders changed are rebuilt.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "grid.hpp"
+#include "open_list.hpp"
+#include "search_space.hpp"
+
+namespace pathfinder {
+
+struct AbstractEdge {
+    int cell; // The node (or goal) at the far end
+    int cost;
+};
+
+class HierarchicalMap {
+public:
+    static constexpr int DEFAULT_CLUSTER_SIZE = 16;
+    // Entrances at least this wide get a transition at each end instead of one
+    // in the middle, so paths are not forced through a single cell
+    static constexpr int WIDE_ENTRANCE = 6;
+
+    explicit HierarchicalMap(const Grid& grid, int clusterSize = DEFAULT_CLUSTER_SIZE)
+        : clusterSize(clusterSize), clusterRows((grid.rows() + clusterSize - 1) / clusterSize),
+          clusterCols((grid.cols() + clusterSize - 1) / clusterSize) {
+        rebuildAll(grid);
+    }
+
+    // Buffers for searches confined to one cluster, indexed by cell position
+    // within the cluster. Queries pass in their own, so a caller that keeps
+    // one across queries stops allocating once it has been sized.
+    struct ClusterScratch {
+        std::vector<int> distance;
+        std::vector<int> parent; // Grid cell index
+        std::vector<int> queue;
+        QuaternaryHeap heap;
+
+        size_t memoryUsage() const {
+            return (distance.capacity() + parent.capacity() + queue.capacity()) * sizeof(int) + heap.memoryUsage();
+        }
+    };
+
+    bool current(const Grid& grid) const { return grid.version() == gridVersion; }
+
+    // Brings the abstract graph up to date with the grid's edits, rebuilding
+    // only the clusters they touched. Returns how many clusters were rebuilt.
+    int update(const Grid& grid) {
+        std::vector<int> edited;
+        if (!grid.editsSince(gridVersion, edited)) {
+            rebuildAll(grid);
+            return static_cast<int>(clusters.size());
+        }
+        gridVersion = grid.version();
+
+        std::vector<int> dirtyClusters;
+        std::vector<int> dirtyRight;
+        std::vector<int> dirtyDown;
+        std::vector<std::uint8_t> marks(clusters.size(), 0); // Bits: cluster, right border, down border
+        auto mark = [&](int cluster, std::uint8_t bit, std::vector<int>& list) {
+            if (!(marks[cluster] & bit)) {
+                marks[cluster] |= bit;
+                list.push_back(cluster);
+            }
+        };
+        for (int index : edited) {
+            Cell cell = grid.cellAt(index);
+            int cluster = clusterOf(cell);
+            int localRow = cell.row % clusterSize;
+            int localCol = cell.col % clusterSize;
+            mark(cluster, 1, dirtyClusters);
+            // A cell on a cluster's edge can change the entrances of that border
+            if (localCol == clusterSize - 1 && cluster % clusterCols + 1 < clusterCols) {
+                mark(cluster, 2, dirtyRight);
+            }
+            if (localCol == 0 && cluster % clusterCols > 0) {
+                mark(cluster - 1, 2, dirtyRight);
+            }
+            if (localRow == clusterSize - 1 && cluster / clusterCols + 1 < clusterRows) {
+                mark(cluster, 4, dirtyDown);
+            }
+            if (localRow == 0 && cluster / clusterCols > 0) {
+                mark(cluster - clusterCols, 4, dirtyDown);
+            }
+        }
+
+        // A changed border changes the nodes on both of its sides
+        for (int cluster : dirtyRight) {
+            findTransitions(grid, cluster, true);
+            mark(cluster, 1, dirtyClusters);
+            mark(cluster + 1, 1, dirtyClusters);
+        }
+        for (int cluster : dirtyDown) {
+            findTransitions(grid, cluster, false);
+            mark(cluster, 1, dirtyClusters);
+            mark(cluster + clusterCols, 1, dirtyClusters);
+        }
+        ClusterScratch scratch;
+        for (int cluster : dirtyClusters) {
+            buildCluster(grid, cluster, scratch);
+        }
+        return static_cast<int>(dirtyClusters.size());
+    }
+
+    int clusterOf(const Cell& cell) const {
+        return (cell.row / clusterSize) * clusterCols + cell.col / clusterSize;
+    }
+
+    // Outgoing abstract edges of a node; empty for cells that are not nodes
+    const std::vector<AbstractEdge>& edges(int index) const {
+        static const std::vector<AbstractEdge> none;
+        if (index >= static_cast<int>(nodeSlot.size()) || nodeSlot[index] < 0) {
+            return none;
+        }
+        return clusters[clusterOf(cellAt(index))].edges[nodeSlot[index]];
+    }
+
+    int nodeCount() const {
+        int count = 0;
+        for (const Cluster& cluster : clusters) {
+            count += static_cast<int>(cluster.nodes.size());
+        }
+        return count;
+    }
+
+    // Links a cell that need not be a node to the nodes of its cluster: the
+    // cost from the cell to each node or, with toCell, from each node to the
+    // cell. Unreachable nodes are left out.
+    void connect(const Grid& grid, int index, bool toCell, std::vector<AbstractEdge>& links,
+                 ClusterScratch& scratch) const {
+        int cluster = clusterOf(grid.cellAt(index));
+        searchCluster(grid, cluster, index, toCell, -1, scratch);
+        for (int node : clusters[cluster].nodes) {
+            int distance = scratch.distance[localIndex(grid.cellAt(node))];
+            if (node != index && distance != SearchSpace::UNREACHED) {
+                links.push_back(AbstractEdge{node, distance});
+            }
+        }
+    }
+
+    // Cost of the cheapest path from one cell to another that stays inside
+    // their common cluster, or SearchSpace::UNREACHED
+    int distanceWithinCluster(const Grid& grid, int from, int to, ClusterScratch& scratch) const {
+        searchCluster(grid, clusterOf(grid.cellAt(from)), from, false, to, scratch);
+        return scratch.distance[localIndex(grid.cellAt(to))];
+    }
+
+    // Turns a chain of abstract nodes into grid cells, appending every cell
+    // after the first waypoint. Consecutive waypoints are either in one
+    // cluster or neighbors across a border.
+    void refine(const Grid& grid, const std::vector<int>& waypoints, std::vector<Cell>& path,
+                ClusterScratch& scratch) const {
+        for (size_t i = 1; i < waypoints.size(); ++i) {
+            int from = waypoints[i - 1];
+            int to = waypoints[i];
+            Cell target = grid.cellAt(to);
+            if (clusterOf(grid.cellAt(from)) != clusterOf(target)) {
+                path.push_back(target);
+                continue;
+            }
+            searchCluster(grid, clusterOf(target), from, false, to, scratch);
+            size_t first = path.size();
+            for (int cell = to; cell != from; cell = scratch.parent[localIndex(grid.cellAt(cell))]) {
+                path.push_back(grid.cellAt(cell));
+            }
+            std::reverse(path.begin() + first, path.end());
+        }
+    }
+
+    size_t memoryUsage() const {
+        size_t bytes = nodeSlot.capacity() * sizeof(int);
+        for (const Cluster& cluster : clusters) {
+            bytes += cluster.nodes.capacity() * sizeof(int);
+            for (const std::vector<AbstractEdge>& nodeEdges : cluster.edges) {
+                bytes += nodeEdges.capacity() * sizeof(AbstractEdge);
+            }
+            bytes += (cluster.right.capacity() + cluster.down.capacity()) * sizeof(Transition);
+        }
+        return bytes;
+    }
+
+private:
+    struct Transition {
+        int inside;  // Cell in this cluster
+        int outside; // Its neighbor across the border
+    };
+
+    struct Cluster {
+        std::vector<int> nodes; // Cell indices
+        std::vector<std::vector<AbstractEdge>> edges; // Per node, same order
+        // Transitions over the borders with the right and lower neighbors;
+        // the left and upper borders belong to the neighbors
+        std::vector<Transition> right;
+        std::vector<Transition> down;
+    };
+
+    int clusterSize;
+    int clusterRows;
+    int clusterCols;
+    int gridColumns = 0;
+    std::uint32_t gridVersion = 0;
+    std::vector<Cluster> clusters;
+    std::vector<int> nodeSlot; // Per cell: position in its cluster's nodes, or -1
+
+    Cell cellAt(int index) const { return Cell{index / gridColumns, index % gridColumns}; }
+
+    int localIndex(const Cell& cell) const {
+        return (cell.row % clusterSize) * clusterSize + cell.col % clusterSize;
+    }
+
+    void rebuildAll(const Grid& grid) {
+        gridVersion = grid.version();
+        gridColumns = grid.cols();
+        clusters.assign(static_cast<size_t>(clusterRows) * clusterCols, Cluster());
+        nodeSlot.assign(grid.cellCount(), -1);
+        for (int cluster = 0; cluster < static_cast<int>(clusters.size()); ++cluster) {
+            if (cluster % clusterCols + 1 < clusterCols) {
+                findTransitions(grid, cluster, true);
+            }
+            if (cluster / clusterCols + 1 < clusterRows) {
+                findTransitions(grid, cluster, false);
+            }
+        }
+        ClusterScratch scratch;
+        for (int cluster = 0; cluster < static_cast<int>(clusters.size()); ++cluster) {
+            buildCluster(grid, cluster, scratch);
+        }
+    }
+
+    // Scans the border with the right (or lower) neighbor for entrances:
+    // maximal runs where the cells on both sides are open
+    void findTransitions(const Grid& grid, int cluster, bool rightBorder) {
+        std::vector<Transition>& transitions = rightBorder ? clusters[cluster].right : clusters[cluster].down;
+        transitions.clear();
+        int top = cluster / clusterCols * clusterSize;
+        int left = cluster % clusterCols * clusterSize;
+        int length = rightBorder ? std::min(clusterSize, grid.rows() - top) : std::min(clusterSize, grid.cols() - left);
+
+        auto transitionAt = [&](int offset) {
+            Cell inside = rightBorder ? Cell{top + offset, left + clusterSize - 1} : Cell{top + clusterSize - 1, left + offset};
+            Cell outside = rightBorder ? Cell{inside.row, inside.col + 1} : Cell{inside.row + 1, inside.col};
+            return Transition{grid.index(inside), grid.index(outside)};
+        };
+
+        int runStart = -1;
+        for (int offset = 0; offset <= length; ++offset) {
+            bool open = false;
+            if (offset < length) {
+                Transition transition = transitionAt(offset);
+                open = grid.passable(transition.inside) && grid.passable(transition.outside);
+            }
+            if (open && runStart < 0) {
+                runStart = offset;
+            } else if (!open && runStart >= 0) {
+                int runEnd = offset - 1;
+                if (runEnd - runStart + 1 >= WIDE_ENTRANCE) {
+                    transitions.push_back(transitionAt(runStart));
+                    transitions.push_back(transitionAt(runEnd));
+                } else {
+                    transitions.push_back(transitionAt((runStart + runEnd) / 2));
+                }
+                runStart = -1;
+            }
+        }
+    }
+
+    // Collects the cluster's nodes from the transitions on its four borders
+    // and links every node to its neighbor across the border and to the other
+    // nodes of the cluster
+    void buildCluster(const Grid& grid, int cluster, ClusterScratch& scratch) {
+        Cluster& data = clusters[cluster];
+        for (int node : data.nodes) {
+            nodeSlot[node] = -1;
+        }
+        data.nodes.clear();
+        data.edges.clear();
+
+        // Stepping into a cell costs that cell's traversal cost
+        auto link = [&](int inside, int outside) {
+            if (nodeSlot[inside] < 0) {
+                nodeSlot[inside] = static_cast<int>(data.nodes.size());
+                data.nodes.push_back(inside);
+                data.edges.emplace_back();
+            }
+            data.edges[nodeSlot[inside]].push_back(AbstractEdge{outside, grid.cost(outside)});
+        };
+        for (const Transition& transition : data.right) {
+            link(transition.inside, transition.outside);
+        }
+        for (const Transition& transition : data.down) {
+            link(transition.inside, transition.outside);
+        }
+        if (cluster % clusterCols > 0) {
+            for (const Transition& transition : clusters[cluster - 1].right) {
+                link(transition.outside, transition.inside);
+            }
+        }
+        if (cluster / clusterCols > 0) {
+            for (const Transition& transition : clusters[cluster - clusterCols].down) {
+                link(transition.outside, transition.inside);
+            }
+        }
+
+        for (size_t i = 0; i < data.nodes.size(); ++i) {
+            searchCluster(grid, cluster, data.nodes[i], false, -1, scratch);
+            for (size_t j = 0; j < data.nodes.size(); ++j) {
+                int distance = scratch.distance[localIndex(grid.cellAt(data.nodes[j]))];
+                if (j != i && distance != SearchSpace::UNREACHED) {
+                    data.edges[i].push_back(AbstractEdge{data.nodes[j], distance});
+                }
+            }
+        }
+    }
+
+    // Dijkstra that never leaves the cluster. Forward distances are costs
+    // from the source to each cell; reverse ones from each cell to the source.
+    // Stops once the target (if not -1) is settled. On a uniform-cost grid a
+    // FIFO queue settles cells in order, which saves the heap.
+    void searchCluster(const Grid& grid, int cluster, int source, bool reverse, int target,
+                       ClusterScratch& scratch) const {
+        int top = cluster / clusterCols * clusterSize;
+        int left = cluster % clusterCols * clusterSize;
+        int bottom = std::min(top + clusterSize, grid.rows());
+        int right = std::min(left + clusterSize, grid.cols());
+
+        size_t clusterCells = static_cast<size_t>(clusterSize) * clusterSize;
+        if (scratch.distance.size() != clusterCells) {
+            scratch.distance.resize(clusterCells);
+            scratch.parent.resize(clusterCells);
+        }
+        bool fifo = grid.uniformCost();
+        size_t head = 0;
+        std::fill(scratch.distance.begin(), scratch.distance.end(), SearchSpace::UNREACHED);
+        scratch.queue.clear();
+        scratch.heap.clear();
+        scratch.distance[localIndex(grid.cellAt(source))] = 0;
+        scratch.parent[localIndex(grid.cellAt(source))] = -1;
+        if (fifo) {
+            scratch.queue.push_back(source);
+        } else {
+            scratch.heap.push(priorityKey(0), source);
+        }
+
+        while (fifo ? head < scratch.queue.size() : !scratch.heap.empty()) {
+            int current;
+            int distance;
+            if (fifo) {
+                current = scratch.queue[head++];
+                distance = scratch.distance[localIndex(grid.cellAt(current))];
+            } else {
+                distance = static_cast<int>(scratch.heap.topKey() >> 32);
+                current = scratch.heap.pop();
+                if (distance > scratch.distance[localIndex(grid.cellAt(current))]) {
+                    continue; // Stale entry
+                }
+            }
+            Cell cell = grid.cellAt(current);
+            if (current == target) {
+                return;
+            }
+            for (const Cell& delta : detail::DELTAS) {
+                Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+                if (neighbor.row < top || neighbor.row >= bottom || neighbor.col < left || neighbor.col >= right) {
+                    continue;
+                }
+                int next = grid.index(neighbor);
+                if (!grid.passable(next)) {
+                    continue;
+                }
+                int newDistance = distance + grid.cost(reverse ? current : next);
+                int& known = scratch.distance[localIndex(neighbor)];
+                if (newDistance < known) {
+                    known = newDistance;
+                    scratch.parent[localIndex(neighbor)] = current;
+                    if (fifo) {
+                        scratch.queue.push_back(next);
+                    } else {
+                        scratch.heap.push(priorityKey(newDistance), next);
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace pathfinder
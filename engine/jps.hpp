@@ -0,0 +1,270 @@
+#pragma once
+
+// Jump Point Search for uniform-cost 4-connected grids.
+//
+// Among the many equally short paths on an open grid, JPS only follows the
+// canonical one that moves horizontally first and turns vertical afterwards.
+// A vertical run may only turn sideways where a wall makes that necessary
+// (a "forced" neighbor: the side cell is open but the one diagonally behind
+// it is blocked). Runs are scanned without touching the open list, and only
+// the cells where a turn may be needed (jump points) are pushed.
+//
+// Scanning a horizontal run looks up and down from every cell it passes, so
+// plain JPS trades heap operations for scanning. JumpTable precomputes, for
+// every cell and direction, how far the next jump point or wall is (JPS+),
+// which turns each scan into a single lookup. Without a table, JumpScanner
+// keeps passability as row and column bitboards and scans a vertical run 64
+// cells per step.
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "bitboard.hpp"
+#include "grid.hpp"
+
+namespace pathfinder {
+
+namespace detail {
+
+// Indices into DELTAS
+const int LEFT = 0;
+const int RIGHT = 1;
+const int UP = 2;
+const int DOWN = 3;
+
+inline bool walkable(const Grid& grid, int row, int col) {
+    return row >= 0 && row < grid.rows() && col >= 0 && col < grid.cols() && grid.passable(row * grid.cols() + col);
+}
+
+// Moving vertically by dr into (row, col), a sideways turn is forced when the
+// side cell is open but the cell diagonally behind it is blocked
+inline bool forcedVertical(const Grid& grid, int row, int col, int dr) {
+    return (walkable(grid, row, col - 1) && !walkable(grid, row - dr, col - 1)) ||
+           (walkable(grid, row, col + 1) && !walkable(grid, row - dr, col + 1));
+}
+
+inline bool jumpVertical(const Grid& grid, const Cell& from, int dr, const Cell& goal, Cell& jumpPoint) {
+    for (int row = from.row + dr; walkable(grid, row, from.col); row += dr) {
+        if ((row == goal.row && from.col == goal.col) || forcedVertical(grid, row, from.col, dr)) {
+            jumpPoint = Cell{row, from.col};
+            return true;
+        }
+    }
+    return false;
+}
+
+// A cell on a horizontal run is a jump point if a vertical run from it would
+// find one, because that is where the canonical path turns
+inline bool jumpHorizontal(const Grid& grid, const Cell& from, int dc, const Cell& goal, Cell& jumpPoint) {
+    Cell ignored;
+    for (int col = from.col + dc; walkable(grid, from.row, col); col += dc) {
+        Cell cell{from.row, col};
+        if (cell == goal || jumpVertical(grid, cell, -1, goal, ignored) || jumpVertical(grid, cell, 1, goal, ignored)) {
+            jumpPoint = cell;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool jump(const Grid& grid, const Cell& from, int direction, const Cell& goal, Cell& jumpPoint) {
+    const Cell& delta = DELTAS[direction];
+    if (delta.row == 0) {
+        return jumpHorizontal(grid, from, delta.col, goal, jumpPoint);
+    }
+    return jumpVertical(grid, from, delta.row, goal, jumpPoint);
+}
+
+} // namespace detail
+
+// Plain JPS over bitboards. A vertical run ends at the first row where the
+// column is blocked, has a forced neighbor or holds the goal; with the columns
+// transposed into rows, each of those is a word-wide mask and the scan is a
+// bit search over 64 rows at a time.
+class JumpScanner {
+public:
+    explicit JumpScanner(const Grid& grid)
+        : gridVersion(grid.version()), byRow(BitBoard::passability(grid)), byColumn(byRow.transposed()) {}
+
+    // The bitboards describe the grid as it was when built
+    bool current(const Grid& grid) const {
+        return grid.version() == gridVersion && grid.rows() == byRow.rows() && grid.cols() == byRow.cols();
+    }
+
+    size_t memoryUsage() const { return byRow.memoryUsage() + byColumn.memoryUsage(); }
+
+    // Same contract as detail::jump()
+    bool jump(const Cell& from, int direction, const Cell& goal, Cell& jumpPoint) const {
+        const Cell& delta = detail::DELTAS[direction];
+        if (delta.row != 0) {
+            return jumpVertical(from, delta.row, goal, jumpPoint);
+        }
+        Cell ignored;
+        for (int col = from.col + delta.col; col >= 0 && col < byRow.cols() && byRow.test(from.row, col);
+             col += delta.col) {
+            Cell cell{from.row, col};
+            if (cell == goal || jumpVertical(cell, -1, goal, ignored) || jumpVertical(cell, 1, goal, ignored)) {
+                jumpPoint = cell;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::uint32_t gridVersion;
+    BitBoard byRow;
+    BitBoard byColumn; // Row c holds column c, bit r for row r
+
+    bool jumpVertical(const Cell& from, int dr, const Cell& goal, Cell& jumpPoint) const {
+        int first = from.row + dr;
+        if (first < 0 || first >= byColumn.cols()) {
+            return false;
+        }
+        const std::uint64_t* column = byColumn.row(from.col);
+        const std::uint64_t* left = from.col > 0 ? byColumn.row(from.col - 1) : nullptr;
+        const std::uint64_t* right = from.col + 1 < byColumn.rows() ? byColumn.row(from.col + 1) : nullptr;
+        int words = byColumn.stride();
+        const std::uint64_t all = ~static_cast<std::uint64_t>(0);
+
+        for (int w = first / 64; w >= 0 && w < words; w += dr) {
+            // A side cell is forced when it is open but the one behind it
+            // (one row against the direction of travel) is not
+            std::uint64_t forced = 0;
+            for (const std::uint64_t* side : {left, right}) {
+                if (!side) {
+                    continue;
+                }
+                std::uint64_t behind = dr > 0 ? (side[w] << 1) | (w > 0 ? side[w - 1] >> 63 : 0)
+                                              : (side[w] >> 1) | (w + 1 < words ? side[w + 1] << 63 : 0);
+                forced |= side[w] & ~behind;
+            }
+            if (goal.col == from.col && goal.row / 64 == w) {
+                forced |= static_cast<std::uint64_t>(1) << (goal.row % 64);
+            }
+            // The run ends at the first stop or blocked cell, whichever comes first
+            std::uint64_t ends = (forced & column[w]) | ~column[w];
+            if (w == first / 64) {
+                int bit = first % 64;
+                ends &= dr > 0 ? all << bit : (bit == 63 ? all : (static_cast<std::uint64_t>(1) << (bit + 1)) - 1);
+            }
+            if (ends) {
+                int bit = dr > 0 ? detail::countTrailingZeros(ends) : 63 - detail::countLeadingZeros(ends);
+                if (!((column[w] >> bit) & 1)) {
+                    return false;
+                }
+                jumpPoint = Cell{w * 64 + bit, from.col};
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Precomputed jump distances (JPS+). For each open cell and direction the
+// table holds d > 0 when the next jump point is d steps away, or -w when the
+// run hits a wall after w open steps. Jump points that depend on the goal are
+// recovered at query time, so one table serves every query on the grid.
+class JumpTable {
+public:
+    explicit JumpTable(const Grid& grid)
+        : gridVersion(grid.version()), cols(grid.cols()), distances(static_cast<size_t>(grid.cellCount()) * 4, 0) {
+        int rows = grid.rows();
+
+        // Vertical runs first; horizontal jump points are defined by them
+        for (int col = 0; col < cols; ++col) {
+            for (int row = rows - 1; row >= 0; --row) {
+                fillStep(grid, row, col, detail::DOWN);
+            }
+            for (int row = 0; row < rows; ++row) {
+                fillStep(grid, row, col, detail::UP);
+            }
+        }
+        for (int row = 0; row < rows; ++row) {
+            for (int col = cols - 1; col >= 0; --col) {
+                fillStep(grid, row, col, detail::RIGHT);
+            }
+            for (int col = 0; col < cols; ++col) {
+                fillStep(grid, row, col, detail::LEFT);
+            }
+        }
+    }
+
+    // The table describes the grid as it was when built
+    bool current(const Grid& grid) const { return grid.version() == gridVersion && grid.cols() == cols; }
+
+    size_t memoryUsage() const { return distances.capacity() * sizeof(std::int32_t); }
+
+    int distance(int index, int direction) const { return distances[static_cast<size_t>(index) * 4 + direction]; }
+
+    // Same contract as detail::jump(), answered from the table
+    bool jump(const Grid& grid, const Cell& from, int direction, const Cell& goal, Cell& jumpPoint) const {
+        const Cell& delta = detail::DELTAS[direction];
+        int d = distance(grid.index(from), direction);
+        int reach = std::abs(d); // Open steps before the jump point or the wall
+
+        if (delta.row == 0) {
+            int toGoal = (goal.col - from.col) * delta.col;
+            if (toGoal > 0 && toGoal <= reach) {
+                // The run passes the goal's column; that cell is a jump point if
+                // a vertical run from it reaches the goal
+                Cell column{from.row, goal.col};
+                int vertical = goal.row > from.row ? detail::DOWN : detail::UP;
+                if (std::abs(distance(grid.index(column), vertical)) >= std::abs(goal.row - from.row)) {
+                    jumpPoint = column;
+                    return true;
+                }
+            }
+        } else {
+            int toGoal = (goal.row - from.row) * delta.row;
+            if (goal.col == from.col && toGoal > 0 && toGoal <= reach) {
+                jumpPoint = goal;
+                return true;
+            }
+        }
+
+        if (d > 0) {
+            jumpPoint = Cell{from.row + delta.row * d, from.col + delta.col * d};
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::uint32_t gridVersion;
+    int cols;
+    std::vector<std::int32_t> distances; // Four directions per cell, interleaved
+
+    int& at(int row, int col, int direction) {
+        return distances[(static_cast<size_t>(row) * cols + col) * 4 + direction];
+    }
+
+    // Derives the entry for (row, col) from its neighbor in the same direction,
+    // which the caller's scan order has already filled in
+    void fillStep(const Grid& grid, int row, int col, int direction) {
+        const Cell& delta = detail::DELTAS[direction];
+        int nextRow = row + delta.row;
+        int nextCol = col + delta.col;
+        if (!detail::walkable(grid, row, col) || !detail::walkable(grid, nextRow, nextCol)) {
+            at(row, col, direction) = 0;
+            return;
+        }
+
+        bool jumpPoint;
+        if (delta.row != 0) {
+            jumpPoint = detail::forcedVertical(grid, nextRow, nextCol, delta.row);
+        } else {
+            jumpPoint = at(nextRow, nextCol, detail::UP) > 0 || at(nextRow, nextCol, detail::DOWN) > 0;
+        }
+
+        int next = at(nextRow, nextCol, direction);
+        if (jumpPoint) {
+            at(row, col, direction) = 1;
+        } else {
+            at(row, col, direction) = next > 0 ? next + 1 : next - 1;
+        }
+    }
+};
+
+} // namespace pathfinder
@@ -0,0 +1,444 @@
+#pragma once
+
+// Landmark (ALT) lower bounds. A few landmark cells are picked far apart and
+// the cost of the cheapest path between each of them and every cell is
+// stored. By the triangle inequality, for any landmark L
+//
+//     d(n, goal) >= d(L, goal) - d(L, n)   and   d(n, goal) >= d(n, L) - d(goal, L)
+//
+// so the largest of these bounds never overestimates, and it is consistent.
+// Where walls force detours Manhattan distance can be off by a wide margin,
+// while a landmark behind the goal gives close to the true distance. A* and
+// greedy best-first use the bounds with four-connected movement.
+//
+// Distances are stored interleaved, all landmarks of a cell side by side, so
+// a bound reads one or two cache lines. On a uniform-cost grid paths cost the
+// same both ways and one table serves both bounds; a weighted grid also keeps
+// the costs towards each landmark.
+//
+// Building costs one Dijkstra per landmark over the whole grid (two on a
+// weighted grid), so tables are built offline with tools/landmarks.cpp and
+// saved next to the map. A saved table records a fingerprint of the grid it
+// was built for and is mapped in place when loaded, like a .grid file. Any
+// grid edit makes a table stale; searches then fall back to Manhattan
+// distance.
+//
+// File layout (all offsets 64-byte aligned):
+//
+//     offset         size                     contents
+//     0              64                       LandmarkFileHeader
+//     cellsOffset    count * 4                landmark cell indices
+//     fromOffset     cells * count * 4        d(landmark, cell), interleaved
+//     toOffset       cells * count * 4        d(cell, landmark), only on weighted grids
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "grid.hpp"
+#include "grid_file.hpp"
+#include "open_list.hpp"
+#include "search_space.hpp"
+
+namespace pathfinder {
+
+const char LANDMARK_FILE_MAGIC[8] = {'P', 'F', 'L', 'M', 'A', 'R', 'K', '\n'};
+const std::uint32_t LANDMARK_FILE_VERSION = 1;
+
+struct LandmarkFileHeader {
+    char magic[8];
+    std::uint32_t byteOrder; // GRID_FILE_BYTE_ORDER as the writer stored it
+    std::uint32_t version;
+    std::int32_t rows;
+    std::int32_t cols;
+    std::int32_t count;
+    std::int32_t directed;           // 1 if the costs towards the landmarks are stored too
+    std::uint64_t gridFingerprint;   // detail::gridFingerprint() of the grid the table was built for
+    std::uint64_t cellsOffset;
+    std::uint64_t fromOffset;
+    std::uint64_t toOffset;          // 0 unless directed
+};
+
+static_assert(sizeof(LandmarkFileHeader) == 64, "landmark file header must stay 64 bytes");
+
+namespace detail {
+
+// Hash of a grid's size, walls and (on weighted grids) costs
+inline std::uint64_t gridFingerprint(const Grid& grid) {
+    std::uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    auto mix = [&](std::uint64_t value) {
+        hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        hash *= 0xFF51AFD7ED558CCDULL;
+    };
+    mix(static_cast<std::uint64_t>(grid.rows()));
+    mix(static_cast<std::uint64_t>(grid.cols()));
+    const std::uint64_t* words = grid.passabilityWords();
+    for (int i = 0; i < (grid.cellCount() + 63) / 64; ++i) {
+        mix(words[i]);
+    }
+    if (!grid.uniformCost()) {
+        const std::uint8_t* costs = grid.costBytes();
+        for (int i = 0; i < grid.cellCount(); i += 8) {
+            std::uint64_t chunk = 0;
+            std::memcpy(&chunk, costs + i, std::min(8, grid.cellCount() - i));
+            mix(chunk);
+        }
+    }
+    return hash;
+}
+
+// Cheapest costs from source to every cell or, with reverse, from every cell
+// to source. A FIFO queue settles cells in order on a uniform-cost grid.
+inline void landmarkDistances(const Grid& grid, int source, bool reverse, std::vector<int>& distance,
+                              std::vector<int>& queue, QuaternaryHeap& heap) {
+    distance.assign(grid.cellCount(), SearchSpace::UNREACHED);
+    queue.clear();
+    heap.clear();
+    bool fifo = grid.uniformCost();
+    size_t head = 0;
+    distance[source] = 0;
+    if (fifo) {
+        queue.push_back(source);
+    } else {
+        heap.push(priorityKey(0), source);
+    }
+    while (fifo ? head < queue.size() : !heap.empty()) {
+        int current;
+        if (fifo) {
+            current = queue[head++];
+        } else {
+            int key = static_cast<int>(heap.topKey() >> 32);
+            current = heap.pop();
+            if (key > distance[current]) {
+                continue; // Stale entry
+            }
+        }
+        Cell cell = grid.cellAt(current);
+        for (const Cell& delta : DELTAS) {
+            Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            if (!grid.contains(neighbor)) {
+                continue;
+            }
+            int next = grid.index(neighbor);
+            if (!grid.passable(next)) {
+                continue;
+            }
+            // Stepping pays for the cell entered; walking a path backwards
+            // enters the cell it came from
+            int newDistance = distance[current] + grid.cost(reverse ? current : next);
+            if (newDistance < distance[next]) {
+                distance[next] = newDistance;
+                if (fifo) {
+                    queue.push_back(next);
+                } else {
+                    heap.push(priorityKey(newDistance), next);
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+class LandmarkTable;
+LandmarkTable loadLandmarkFile(const std::string& path, const Grid& grid);
+
+class LandmarkTable {
+public:
+    static constexpr int DEFAULT_COUNT = 8;
+    static constexpr int MAX_COUNT = 32;
+
+    // Distances between each landmark and one query's goal, looked up once
+    // per query so a bound reads only the cell's own entries
+    struct Goal {
+        std::int32_t fromLandmark[MAX_COUNT];
+        std::int32_t toLandmark[MAX_COUNT];
+    };
+
+    // Places up to count landmarks in the grid's largest connected region,
+    // each as far as possible from the ones before it (fewer if the region
+    // has fewer cells). Throws std::invalid_argument unless 1 <= count <=
+    // MAX_COUNT.
+    explicit LandmarkTable(const Grid& grid, int count = DEFAULT_COUNT) {
+        if (count < 1 || count > MAX_COUNT) {
+            throw std::invalid_argument("landmark count must be between 1 and LandmarkTable::MAX_COUNT");
+        }
+        build(grid, count);
+    }
+
+    // Tables point into their own buffers or a mapping, so they move but do
+    // not copy
+    LandmarkTable(LandmarkTable&&) = default;
+    LandmarkTable& operator=(LandmarkTable&&) = default;
+    LandmarkTable(const LandmarkTable&) = delete;
+    LandmarkTable& operator=(const LandmarkTable&) = delete;
+
+    // The distances describe the grid as it is now
+    bool current(const Grid& grid) const {
+        return grid.version() == gridVersion && grid.rows() == rowCount && grid.cols() == colCount;
+    }
+
+    int count() const { return landmarkCount; }
+    int landmark(int k) const { return cells[k]; }
+    bool directed() const { return toTable != fromTable; }
+    std::uint64_t fingerprint() const { return gridHash; }
+
+    void aim(int goal, Goal& target) const {
+        for (int k = 0; k < landmarkCount; ++k) {
+            target.fromLandmark[k] = fromTable[static_cast<size_t>(goal) * landmarkCount + k];
+            target.toLandmark[k] = toTable[static_cast<size_t>(goal) * landmarkCount + k];
+        }
+    }
+
+    // Lower bound on the cost from the cell to the target's goal; 0 if no
+    // landmark reaches both
+    int lowerBound(int index, const Goal& target) const {
+        const std::int32_t* from = fromTable + static_cast<size_t>(index) * landmarkCount;
+        const std::int32_t* to = toTable + static_cast<size_t>(index) * landmarkCount;
+        int best = 0;
+        for (int k = 0; k < landmarkCount; ++k) {
+            if (from[k] == SearchSpace::UNREACHED || target.fromLandmark[k] == SearchSpace::UNREACHED) {
+                continue;
+            }
+            best = std::max(best, target.fromLandmark[k] - from[k]);
+            best = std::max(best, to[k] - target.toLandmark[k]);
+        }
+        return best;
+    }
+
+    // Raw tables for saving: cellCount * count entries each, cell-major
+    const std::int32_t* fromLandmarks() const { return fromTable; }
+    const std::int32_t* toLandmarks() const { return toTable; }
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+
+    size_t memoryUsage() const {
+        size_t entries = static_cast<size_t>(rowCount) * colCount * landmarkCount;
+        return (directed() ? 2 : 1) * entries * sizeof(std::int32_t) + cells.capacity() * sizeof(int);
+    }
+
+private:
+    friend LandmarkTable loadLandmarkFile(const std::string& path, const Grid& grid);
+
+    LandmarkTable() = default;
+
+    int rowCount = 0;
+    int colCount = 0;
+    int landmarkCount = 0;
+    std::uint32_t gridVersion = 0;
+    std::uint64_t gridHash = 0;
+    std::vector<int> cells;
+    std::vector<std::int32_t> ownedDistances; // Both tables when built here
+    std::shared_ptr<void> mapping;            // Keeps a loaded file mapped
+    const std::int32_t* fromTable = nullptr;
+    const std::int32_t* toTable = nullptr;
+
+    void build(const Grid& grid, int count) {
+        rowCount = grid.rows();
+        colCount = grid.cols();
+        gridVersion = grid.version();
+        gridHash = detail::gridFingerprint(grid);
+
+        std::vector<int> distance;
+        std::vector<int> queue;
+        QuaternaryHeap heap;
+        int regionSize = 0;
+        int seed = largestRegionCell(grid, queue, regionSize);
+        landmarkCount = std::min(count, regionSize);
+        bool weighted = !grid.uniformCost();
+        size_t entries = static_cast<size_t>(grid.cellCount()) * landmarkCount;
+        ownedDistances.assign(weighted ? 2 * entries : entries, 0);
+        std::int32_t* from = ownedDistances.data();
+        std::int32_t* to = weighted ? from + entries : from;
+        fromTable = from;
+        toTable = to;
+        if (seed < 0) {
+            return; // No open cell, nothing to bound
+        }
+
+        // The first landmark goes as far as possible from an arbitrary cell
+        // of the region, each later one as far as possible from its nearest
+        // predecessor. Cells outside the region stay UNREACHED and are never
+        // picked.
+        detail::landmarkDistances(grid, seed, false, distance, queue, heap);
+        std::vector<int> nearest = distance;
+        for (int k = 0; k < landmarkCount; ++k) {
+            int farthest = seed;
+            for (int i = 0; i < grid.cellCount(); ++i) {
+                if (nearest[i] != SearchSpace::UNREACHED && nearest[i] > nearest[farthest]) {
+                    farthest = i;
+                }
+            }
+            cells.push_back(farthest);
+            detail::landmarkDistances(grid, farthest, false, distance, queue, heap);
+            for (int i = 0; i < grid.cellCount(); ++i) {
+                from[static_cast<size_t>(i) * landmarkCount + k] = distance[i];
+                nearest[i] = k == 0 ? distance[i] : std::min(nearest[i], distance[i]);
+            }
+            if (weighted) {
+                detail::landmarkDistances(grid, farthest, true, distance, queue, heap);
+                for (int i = 0; i < grid.cellCount(); ++i) {
+                    to[static_cast<size_t>(i) * landmarkCount + k] = distance[i];
+                }
+            }
+        }
+    }
+
+    // A cell of the largest four-connected region of open cells, or -1 if
+    // there is none; size receives the region's cell count
+    static int largestRegionCell(const Grid& grid, std::vector<int>& queue, int& size) {
+        std::vector<bool> seen(grid.cellCount(), false);
+        int best = -1;
+        size = 0;
+        for (int i = 0; i < grid.cellCount(); ++i) {
+            if (seen[i] || !grid.passable(i)) {
+                continue;
+            }
+            queue.clear();
+            queue.push_back(i);
+            seen[i] = true;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                Cell cell = grid.cellAt(queue[head]);
+                for (const Cell& delta : detail::DELTAS) {
+                    Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+                    if (grid.contains(neighbor) && !seen[grid.index(neighbor)] &&
+                        grid.passable(grid.index(neighbor))) {
+                        seen[grid.index(neighbor)] = true;
+                        queue.push_back(grid.index(neighbor));
+                    }
+                }
+            }
+            if (static_cast<int>(queue.size()) > size) {
+                size = static_cast<int>(queue.size());
+                best = i;
+            }
+        }
+        return best;
+    }
+};
+
+// Where the landmarks of a map are kept: city.map (or city.grid) becomes
+// city.landmarks
+inline std::string landmarkFileFor(const std::string& mapFile) {
+    size_t extension = mapFile.find_last_of('.');
+    if (extension == std::string::npos || mapFile.find_first_of("/\\", extension) != std::string::npos) {
+        extension = mapFile.size();
+    }
+    return mapFile.substr(0, extension) + ".landmarks";
+}
+
+// Opens a table written by saveLandmarkFile() for the given grid; the table
+// uses the mapping in place. Throws std::runtime_error if the file cannot be
+// mapped, is not a valid landmark file or was built for a different grid.
+inline LandmarkTable loadLandmarkFile(const std::string& path, const Grid& grid) {
+    std::shared_ptr<detail::MappedFile> file = std::make_shared<detail::MappedFile>(path);
+    if (file->size() < sizeof(LandmarkFileHeader)) {
+        throw std::runtime_error(path + " is too short to be a landmark file");
+    }
+    LandmarkFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, LANDMARK_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error(path + " is not a landmark file");
+    }
+    if (header.byteOrder != GRID_FILE_BYTE_ORDER) {
+        throw std::runtime_error(path + " was written on a machine with a different byte order");
+    }
+    if (header.version != LANDMARK_FILE_VERSION) {
+        throw std::runtime_error(path + " has unsupported landmark file version " + std::to_string(header.version));
+    }
+    if (header.rows != grid.rows() || header.cols != grid.cols() ||
+        header.gridFingerprint != detail::gridFingerprint(grid)) {
+        throw std::runtime_error(path + " was built for a different map");
+    }
+    if (header.count < 0 || header.count > LandmarkTable::MAX_COUNT || (header.directed != 0) == grid.uniformCost()) {
+        throw std::runtime_error(path + " has an invalid landmark count or layout");
+    }
+    std::uint64_t entries = static_cast<std::uint64_t>(grid.cellCount()) * header.count;
+    auto fits = [&](std::uint64_t offset, std::uint64_t bytes) {
+        return offset % 64 == 0 && offset >= sizeof(header) && offset <= file->size() && file->size() - offset >= bytes;
+    };
+    if (!fits(header.cellsOffset, header.count * sizeof(std::int32_t)) ||
+        !fits(header.fromOffset, entries * sizeof(std::int32_t)) ||
+        (header.directed && !fits(header.toOffset, entries * sizeof(std::int32_t)))) {
+        throw std::runtime_error(path + " is truncated or has a bad table offset");
+    }
+
+    LandmarkTable table;
+    table.rowCount = grid.rows();
+    table.colCount = grid.cols();
+    table.landmarkCount = header.count;
+    table.gridVersion = grid.version();
+    table.gridHash = header.gridFingerprint;
+    const std::int32_t* cells = reinterpret_cast<const std::int32_t*>(file->data() + header.cellsOffset);
+    for (int k = 0; k < header.count; ++k) {
+        if (cells[k] < 0 || cells[k] >= grid.cellCount()) {
+            throw std::runtime_error(path + " has a landmark outside the map");
+        }
+        table.cells.push_back(cells[k]);
+    }
+    table.fromTable = reinterpret_cast<const std::int32_t*>(file->data() + header.fromOffset);
+    table.toTable = header.directed ? reinterpret_cast<const std::int32_t*>(file->data() + header.toOffset)
+                                    : table.fromTable;
+    table.mapping = std::move(file);
+    return table;
+}
+
+// Writes the table in the format loadLandmarkFile() reads, next to the
+// target and renamed over it. Throws std::runtime_error on I/O failure.
+inline void saveLandmarkFile(const LandmarkTable& table, const std::string& path) {
+    std::uint64_t entries = static_cast<std::uint64_t>(table.rows()) * table.cols() * table.count();
+    std::uint64_t tableBytes = entries * sizeof(std::int32_t);
+
+    LandmarkFileHeader header = {};
+    std::memcpy(header.magic, LANDMARK_FILE_MAGIC, sizeof(header.magic));
+    header.byteOrder = GRID_FILE_BYTE_ORDER;
+    header.version = LANDMARK_FILE_VERSION;
+    header.rows = table.rows();
+    header.cols = table.cols();
+    header.count = table.count();
+    header.directed = table.directed() ? 1 : 0;
+    header.gridFingerprint = table.fingerprint();
+    header.cellsOffset = sizeof(header);
+    header.fromOffset = detail::alignTo64(header.cellsOffset + table.count() * sizeof(std::int32_t));
+    header.toOffset = table.directed() ? detail::alignTo64(header.fromOffset + tableBytes) : 0;
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("cannot create " + temporary);
+        }
+        static const char padding[64] = {};
+        auto padTo = [&](std::uint64_t offset) {
+            out.write(padding, static_cast<std::streamsize>(offset - static_cast<std::uint64_t>(out.tellp())));
+        };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int k = 0; k < table.count(); ++k) {
+            std::int32_t cell = table.landmark(k);
+            out.write(reinterpret_cast<const char*>(&cell), sizeof(cell));
+        }
+        padTo(header.fromOffset);
+        out.write(reinterpret_cast<const char*>(table.fromLandmarks()), static_cast<std::streamsize>(tableBytes));
+        if (table.directed()) {
+            padTo(header.toOffset);
+            out.write(reinterpret_cast<const char*>(table.toLandmarks()), static_cast<std::streamsize>(tableBytes));
+        }
+        if (!out.flush()) {
+            throw std::runtime_error("cannot write " + temporary);
+        }
+    }
+    // Windows will not rename over an existing file
+    if (std::rename(temporary.c_str(), path.c_str()) != 0 &&
+        (std::remove(path.c_str()) != 0 || std::rename(temporary.c_str(), path.c_str()) != 0)) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("cannot replace " + path);
+    }
+}
+
+} // namespace pathfinder
@@ -0,0 +1,229 @@
+#pragma once
+
+// Loading maps from disk. Text maps use the MovingAI benchmark format
+// (https://movingai.com/benchmarks/formats.html):
+//
+//     type octile
+//     height <rows>
+//     width <cols>
+//     map
+//     <rows lines of <cols> characters>
+//
+// '.', 'G' and 'S' (swamp) are passable, every other character is a wall.
+//
+// Occupancy images are PGM files (binary P5 or plain P2), read the way ROS
+// map_server reads them: dark pixels are occupied, and only pixels whose
+// occupancy (maxval - value) / maxval is below PGM_FREE_THRESHOLD are free.
+// Unknown (grey) space counts as a wall.
+//
+// Both import into an ordinary Grid; save it with saveGridFile() to get a
+// binary map that loads without parsing. loadMap() picks the reader from the
+// file name.
+//
+// Scenario (.scen) files list benchmark queries for a map, one per line after
+// a "version 1" header:
+//
+//     <bucket> <map> <width> <height> <startX> <startY> <goalX> <goalY> <optimal>
+//
+// x is the column and y the row. The optimal length assumes 8-connected
+// movement with diagonal steps costing sqrt(2).
+
+#include <cctype>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "grid.hpp"
+#include "grid_file.hpp"
+
+namespace pathfinder {
+
+namespace detail {
+
+inline bool movingAiPassable(char terrain) {
+    return terrain == '.' || terrain == 'G' || terrain == 'S';
+}
+
+// Reads one header number, skipping whitespace and # comments
+inline int readPgmNumber(std::istream& in) {
+    while (true) {
+        int next = in.peek();
+        if (next == '#') {
+            std::string comment;
+            std::getline(in, comment);
+        } else if (next != EOF && std::isspace(next)) {
+            in.get();
+        } else {
+            break;
+        }
+    }
+    int value;
+    if (!(in >> value)) {
+        throw std::runtime_error("malformed PGM header");
+    }
+    return value;
+}
+
+inline bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace detail
+
+// Throws std::runtime_error if the input is not a well-formed map
+inline Grid loadMovingAiMap(std::istream& in) {
+    std::string word;
+    int rows = -1;
+    int cols = -1;
+    while (in >> word && word != "map") {
+        if (word == "height") {
+            in >> rows;
+        } else if (word == "width") {
+            in >> cols;
+        } else if (word == "type") {
+            in >> word;
+        } else {
+            throw std::runtime_error("unexpected map header field '" + word + "'");
+        }
+    }
+    if (!in || rows <= 0 || cols <= 0) {
+        throw std::runtime_error("map header needs a positive height and width followed by 'map'");
+    }
+
+    Grid grid(rows, cols);
+    std::string line;
+    std::getline(in, line); // Rest of the "map" line
+    for (int row = 0; row < rows; ++row) {
+        if (!std::getline(in, line)) {
+            throw std::runtime_error("map ends after " + std::to_string(row) + " of " + std::to_string(rows) + " rows");
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (static_cast<int>(line.size()) < cols) {
+            throw std::runtime_error("map row " + std::to_string(row) + " is shorter than the width");
+        }
+        for (int col = 0; col < cols; ++col) {
+            if (!detail::movingAiPassable(line[col])) {
+                grid.setCell(Cell{row, col}, false);
+            }
+        }
+    }
+    return grid;
+}
+
+inline Grid loadMovingAiMap(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open map file " + path);
+    }
+    return loadMovingAiMap(in);
+}
+
+// ROS map_server's default free_thresh
+const double PGM_FREE_THRESHOLD = 0.196;
+
+// Throws std::runtime_error if the input is not a well-formed PGM image
+inline Grid loadPgmMap(std::istream& in) {
+    char magic[2];
+    if (!in.read(magic, 2) || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '2')) {
+        throw std::runtime_error("not a PGM image (expected P5 or P2)");
+    }
+    bool binary = magic[1] == '5';
+    int cols = detail::readPgmNumber(in);
+    int rows = detail::readPgmNumber(in);
+    int maxValue = detail::readPgmNumber(in);
+    if (rows <= 0 || cols <= 0 || maxValue <= 0 || maxValue > 65535) {
+        throw std::runtime_error("PGM header needs a positive size and a maxval up to 65535");
+    }
+    in.get(); // The single whitespace character before binary data
+
+    Grid grid(rows, cols);
+    int bytesPerPixel = maxValue < 256 ? 1 : 2;
+    std::vector<unsigned char> row(static_cast<size_t>(cols) * bytesPerPixel);
+    for (int r = 0; r < rows; ++r) {
+        if (binary && !in.read(reinterpret_cast<char*>(row.data()), static_cast<std::streamsize>(row.size()))) {
+            throw std::runtime_error("PGM image ends after " + std::to_string(r) + " of " + std::to_string(rows) +
+                                     " rows");
+        }
+        for (int c = 0; c < cols; ++c) {
+            int value;
+            if (binary) {
+                // Two-byte samples are big-endian
+                value = bytesPerPixel == 1 ? row[c] : (row[2 * c] << 8) | row[2 * c + 1];
+            } else if (!(in >> value)) {
+                throw std::runtime_error("PGM image ends after " + std::to_string(r) + " of " + std::to_string(rows) +
+                                         " rows");
+            }
+            double occupancy = static_cast<double>(maxValue - value) / maxValue;
+            if (occupancy >= PGM_FREE_THRESHOLD) {
+                grid.setCell(Cell{r, c}, false);
+            }
+        }
+    }
+    return grid;
+}
+
+inline Grid loadPgmMap(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open map file " + path);
+    }
+    return loadPgmMap(in);
+}
+
+// Reads a binary .grid file (mapped, see grid_file.hpp), a .pgm occupancy
+// image or, for any other name, a MovingAI map
+inline Grid loadMap(const std::string& path) {
+    if (detail::endsWith(path, ".grid")) {
+        return loadGridFile(path);
+    }
+    if (detail::endsWith(path, ".pgm")) {
+        return loadPgmMap(path);
+    }
+    return loadMovingAiMap(path);
+}
+
+struct ScenarioQuery {
+    int bucket = 0;
+    Cell start;
+    Cell goal;
+    double optimalLength = 0.0;
+};
+
+// Throws std::runtime_error on a malformed line
+inline std::vector<ScenarioQuery> loadMovingAiScenario(std::istream& in) {
+    std::vector<ScenarioQuery> queries;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.compare(0, 7, "version") == 0 || line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(line);
+        ScenarioQuery query;
+        std::string mapName;
+        int width;
+        int height;
+        if (!(fields >> query.bucket >> mapName >> width >> height >> query.start.col >> query.start.row >>
+              query.goal.col >> query.goal.row >> query.optimalLength)) {
+            throw std::runtime_error("malformed scenario line " + std::to_string(lineNumber));
+        }
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+inline std::vector<ScenarioQuery> loadMovingAiScenario(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open scenario file " + path);
+    }
+    return loadMovingAiScenario(in);
+}
+
+} // namespace pathfinder
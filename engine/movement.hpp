@@ -0,0 +1,206 @@
+#pragma once
+
+// How a path may move between cells. By default searches step to the four
+// side neighbors and a path costs the sum of the cells it enters. With
+// eight-connected movement a path may also step diagonally, paying the
+// entered cell's cost times sqrt(2). The any-angle searches (Theta*, Lazy
+// Theta*) go further and join any two cells that can see each other with a
+// straight segment that costs its length.
+//
+// Diagonal and any-angle searches keep distances in fixed point,
+// DISTANCE_UNIT to a straight step, so they run on the same integer keys as
+// the rest. A path then fits in an int up to about 2^31 / DIAGONAL_STEP /
+// Grid::MAX_COST diagonal steps through the most expensive cells.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "grid.hpp"
+
+namespace pathfinder {
+
+enum class Connectivity {
+    Four, // Side neighbors only
+    Eight // Side and diagonal neighbors
+};
+
+// When a diagonal step (or an any-angle segment through a grid corner) may
+// pass between the two cells beside it
+enum class CornerRule {
+    Cut,       // Always, even between two walls
+    NoSqueeze, // Unless both are walls
+    NoCut      // Only if both are open. MovingAI scenario lengths assume this.
+};
+
+// What searches estimate the remaining distance with. Four-connected
+// searches use Manhattan distance, which is exact on an open grid for them,
+// unless A* or greedy best-first has a current LandmarkTable to tighten it.
+enum class Heuristic {
+    Automatic, // Octile for eight-connected movement, Euclidean for any-angle, landmarks when there are some
+    Manhattan, // Overestimates diagonal moves: faster, but paths may not be the cheapest
+    Octile,    // Exact on an open grid with eight-connected movement
+    Euclidean, // Straight-line distance, the only admissible one for any-angle paths
+    Landmarks  // Manhattan distance raised to the landmark bound (landmarks.hpp); four-connected only
+};
+
+struct Movement {
+    Connectivity connectivity = Connectivity::Four;
+    CornerRule corners = CornerRule::NoCut;
+    Heuristic heuristic = Heuristic::Automatic;
+};
+
+const int DISTANCE_UNIT = 256;
+const int DIAGONAL_STEP = 362; // sqrt(2) * DISTANCE_UNIT, rounded
+
+inline const char* connectivityName(Connectivity connectivity) {
+    return connectivity == Connectivity::Four ? "4-way" : "8-way";
+}
+
+inline const char* cornerRuleName(CornerRule corners) {
+    switch (corners) {
+        case CornerRule::Cut: return "corners cut";
+        case CornerRule::NoSqueeze: return "no squeezing";
+        case CornerRule::NoCut: return "no corner cutting";
+    }
+    return "";
+}
+
+namespace detail {
+
+constexpr Cell DIAGONAL_DELTAS[4] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+
+// DELTAS followed by DIAGONAL_DELTAS, so a loop over the first four or all
+// eight moves has a trip count the compiler knows
+constexpr Cell MOVES[8] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+
+template <Connectivity connectivity>
+constexpr int moveCount() {
+    return connectivity == Connectivity::Four ? 4 : 8;
+}
+
+// Length of a side step: four-connected searches count plain cells
+template <Connectivity connectivity>
+constexpr int sideStep() {
+    return connectivity == Connectivity::Four ? 1 : DISTANCE_UNIT;
+}
+
+inline bool openCell(const Grid& grid, int row, int col) {
+    return row >= 0 && row < grid.rows() && col >= 0 && col < grid.cols() && grid.passable(row * grid.cols() + col);
+}
+
+// Whether a path may pass between two cells that touch only at a corner,
+// given whether the two cells beside that corner are open
+inline bool passesCorner(CornerRule corners, bool sideOpen, bool otherSideOpen) {
+    switch (corners) {
+        case CornerRule::Cut: return true;
+        case CornerRule::NoSqueeze: return sideOpen || otherSideOpen;
+        case CornerRule::NoCut: return sideOpen && otherSideOpen;
+    }
+    return false;
+}
+
+// The diagonal step from cell by delta; the target itself is not checked
+inline bool diagonalAllowed(const Grid& grid, const Cell& cell, const Cell& delta, CornerRule corners) {
+    return passesCorner(corners, openCell(grid, cell.row + delta.row, cell.col),
+                        openCell(grid, cell.row, cell.col + delta.col));
+}
+
+// Fixed-point distances in DISTANCE_UNIT
+inline int octile(const Cell& a, const Cell& b) {
+    int dr = std::abs(a.row - b.row);
+    int dc = std::abs(a.col - b.col);
+    return std::abs(dr - dc) * DISTANCE_UNIT + std::min(dr, dc) * DIAGONAL_STEP;
+}
+
+// Rounded, the cost of a segment on a uniform grid
+inline int segmentLength(const Cell& a, const Cell& b) {
+    double dr = a.row - b.row;
+    double dc = a.col - b.col;
+    return static_cast<int>(std::lround(std::sqrt(dr * dr + dc * dc) * DISTANCE_UNIT));
+}
+
+// Rounded down, so it never exceeds the segment it bounds
+inline int euclidean(const Cell& a, const Cell& b) {
+    double dr = a.row - b.row;
+    double dc = a.col - b.col;
+    return static_cast<int>(std::sqrt(dr * dr + dc * dc) * DISTANCE_UNIT);
+}
+
+// The heuristic fixed at compile time, in the units of the given movement
+template <Heuristic heuristic, Connectivity connectivity>
+int estimate(const Cell& from, const Cell& to) {
+    if (heuristic == Heuristic::Octile) {
+        return octile(from, to);
+    }
+    if (heuristic == Heuristic::Euclidean) {
+        return euclidean(from, to);
+    }
+    return manhattan(from, to) * sideStep<connectivity>();
+}
+
+// Walks the cells the segment between the centers of a and b passes
+// through, from a to b, calling visit(row, col) for each. Where the segment
+// crosses a grid corner exactly it touches neither of the two cells beside
+// it, and corner(row, col, otherRow, otherCol) decides whether it may pass.
+// Integer steps only: the error term tracks which grid line the segment
+// crosses next. Stops and returns false as soon as a callback does.
+template <typename Visit, typename Corner>
+bool traceLine(const Cell& a, const Cell& b, Visit visit, Corner corner) {
+    int dr = std::abs(b.row - a.row);
+    int dc = std::abs(b.col - a.col);
+    int stepRow = b.row > a.row ? 1 : -1;
+    int stepCol = b.col > a.col ? 1 : -1;
+    int row = a.row;
+    int col = a.col;
+    int error = dc - dr;
+    while (true) {
+        if (!visit(row, col)) {
+            return false;
+        }
+        if (row == b.row && col == b.col) {
+            return true;
+        }
+        if (error > 0) {
+            col += stepCol;
+            error -= 2 * dr;
+        } else if (error < 0) {
+            row += stepRow;
+            error += 2 * dc;
+        } else {
+            if (!corner(row + stepRow, col, row, col + stepCol)) {
+                return false;
+            }
+            row += stepRow;
+            col += stepCol;
+            error += 2 * dc - 2 * dr;
+        }
+    }
+}
+
+// A straight segment between the two cells' centers crosses only open
+// cells, and grid corners only as the corner rule allows
+inline bool lineOfSight(const Grid& grid, const Cell& a, const Cell& b, CornerRule corners) {
+    return traceLine(
+        a, b, [&](int row, int col) { return openCell(grid, row, col); },
+        [&](int row, int col, int otherRow, int otherCol) {
+            return passesCorner(corners, openCell(grid, row, col), openCell(grid, otherRow, otherCol));
+        });
+}
+
+} // namespace detail
+
+// The cells of an any-angle path's straight segment from a to b, both
+// included, for drawing or following it cell by cell
+inline void cellsOnSegment(const Cell& a, const Cell& b, std::vector<Cell>& cells) {
+    detail::traceLine(
+        a, b,
+        [&](int row, int col) {
+            cells.push_back(Cell{row, col});
+            return true;
+        },
+        [](int, int, int, int) { return true; });
+}
+
+} // namespace pathfinder
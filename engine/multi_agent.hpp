@@ -0,0 +1,633 @@
+#pragma once
+
+// Multi-agent planning: many agents share one grid, each with its own start
+// and goal, and time advances in steps. At every step an agent moves to a
+// side neighbor or waits, and no two agents may stand in the same cell at the
+// same step or swap cells across one side. An agent that reaches its goal
+// rests there, so nobody may pass through that cell afterwards.
+//
+// The single-agent building block is space-time A*. Its states are (cell,
+// step) pairs, and it keeps out of whatever a ReservationTable holds. The
+// table hashes the reserved (cell, step) pairs and moves instead of storing
+// a copy of the grid per step, so it only takes memory for what is actually
+// reserved. Past the table's last reserved step nothing changes any more, so
+// the search treats all later steps as one, which keeps it finite when there
+// is no way. It estimates with the distances of a FlowField to the agent's
+// goal: exact for an agent alone, so never more than with the others around.
+//
+// Cooperative A* plans the agents one after another in the given order, each
+// reserving its path for the ones that follow. It is fast but neither
+// optimal nor complete: an early agent may rest in a corridor a later one
+// needs.
+//
+// Conflict-Based Search (CBS) finds a plan with the lowest sum of costs. It
+// plans every agent alone, then looks for the earliest conflict between two
+// paths and branches: one child forbids the first agent that cell or move at
+// that step, the other forbids the second, and each replans only the agent
+// it constrains. Plans are expanded cheapest first, fewer conflicts first
+// among equally cheap ones. A replan takes, of the equally cheap paths, the
+// one that runs into the other agents' paths least, and one that costs no
+// more than before and leaves fewer conflicts replaces its parent instead of
+// branching (a bypass). The agents' first plans and the two replans of a
+// branch do not depend on each other, so they run in parallel on a
+// ThreadPool.
+//
+// Costs are those of the four-connected searches: a step pays for the cell
+// it enters, and a wait pays for the cell waited in, as though stepping into
+// it again. An agent's cost stops once it rests at its goal.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "flow_field.hpp"
+#include "grid.hpp"
+#include "open_list.hpp"
+#include "search_space.hpp"
+#include "thread_pool.hpp"
+
+namespace pathfinder {
+
+struct Agent {
+    Cell start;
+    Cell goal;
+};
+
+enum class MultiAgentSolver {
+    Cooperative,  // Cooperative A*: one agent after another, fast but may miss plans
+    ConflictBased // CBS: the lowest sum of costs
+};
+
+inline const char* multiAgentSolverName(MultiAgentSolver solver) {
+    return solver == MultiAgentSolver::Cooperative ? "Cooperative A*" : "CBS";
+}
+
+// CBS gives up after expanding this many plans
+const int CBS_NODE_LIMIT = 20000;
+
+struct MultiAgentPlan {
+    bool found = false;
+    // Per agent, its cell at every step until it rests at its goal
+    std::vector<std::vector<Cell>> paths;
+    std::vector<int> costs;
+    int cost = 0;          // Sum over the agents
+    int makespan = 0;      // Steps until the last agent rests
+    int expansions = 0;    // Space-time states expanded by all single-agent searches
+    int conflictNodes = 0; // Plans CBS expanded, each resolving one conflict
+    // CBS stopped at its node limit; the paths, if found, are Cooperative A*'s
+    // and need not have the lowest sum of costs
+    bool limitReached = false;
+};
+
+// Where an agent stands at a step; past the end of its path it rests at its goal
+inline const Cell& positionAt(const std::vector<Cell>& path, int step) {
+    return path[std::min(step, static_cast<int>(path.size()) - 1)];
+}
+
+// Two agents in the same cell at a step, or swapping cells on the way to it
+struct AgentConflict {
+    int first = -1; // -1: no conflict
+    int second = -1;
+    int step = 0;
+    Cell cell;         // Where the first agent is at the step
+    Cell from;         // Where the first agent was the step before
+    bool swap = false; // The agents swapped cells rather than meeting in one
+};
+
+// Cells and moves kept free for other agents, hashed by step. An agent's
+// whole path reserves each of its cells at its step, the reverse of each of
+// its moves (so nobody swaps cells with it) and, from its arrival on, its
+// goal.
+class ReservationTable {
+public:
+    explicit ReservationTable(const Grid& grid) : cols(grid.cols()) {}
+
+    void clear() {
+        cells.clear();
+        moves.clear();
+        lastSteps.clear();
+        restingFrom.clear();
+        lastStep = -1;
+    }
+
+    // Makes room for this many more reserved cells and moves without rehashing
+    void reserve(size_t steps) {
+        cells.reserve(cells.size() + steps);
+        moves.reserve(moves.size() + steps);
+        lastSteps.reserve(lastSteps.size() + steps);
+    }
+
+    void reserveCell(int cell, int step) {
+        cells.insert(cellKey(cell, step));
+        noteStep(cell, step);
+    }
+
+    // Forbids stepping from one cell to a side neighbor, arriving at the step
+    void blockMove(int from, int to, int step) {
+        moves.insert(moveKey(from, to, step));
+        lastStep = std::max(lastStep, step);
+    }
+
+    // Keeps the cell for an agent that arrives at the step and stays
+    void reserveFrom(int cell, int step) {
+        restingFrom[cell] = step;
+        lastStep = std::max(lastStep, step);
+    }
+
+    void reservePath(const std::vector<Cell>& path) {
+        for (size_t step = 0; step < path.size(); ++step) {
+            int cell = index(path[step]);
+            reserveCell(cell, static_cast<int>(step));
+            if (step > 0 && path[step - 1] != path[step]) {
+                blockMove(cell, index(path[step - 1]), static_cast<int>(step));
+            }
+        }
+        reserveFrom(index(path.back()), static_cast<int>(path.size()) - 1);
+    }
+
+    bool cellFree(int cell, int step) const {
+        if (cells.count(cellKey(cell, step))) {
+            return false;
+        }
+        auto resting = restingFrom.find(cell);
+        return resting == restingFrom.end() || step < resting->second;
+    }
+
+    bool moveFree(int from, int to, int step) const { return !moves.count(moveKey(from, to, step)); }
+
+    // The last step at which the cell is reserved, -1 if never and INT_MAX
+    // if an agent rests there
+    int lastReserved(int cell) const {
+        if (restingFrom.count(cell)) {
+            return INT_MAX;
+        }
+        auto last = lastSteps.find(cell);
+        return last == lastSteps.end() ? -1 : last->second;
+    }
+
+    // The last step anything is reserved at; after it the table stays the same
+    int horizon() const { return lastStep; }
+
+private:
+    int cols;
+    std::unordered_set<std::uint64_t> cells;
+    std::unordered_set<std::uint64_t> moves;
+    std::unordered_map<int, int> lastSteps;
+    std::unordered_map<int, int> restingFrom;
+    int lastStep = -1;
+
+    int index(const Cell& cell) const { return cell.row * cols + cell.col; }
+
+    static std::uint64_t cellKey(int cell, int step) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(step)) << 32 | static_cast<std::uint32_t>(cell);
+    }
+
+    // The move's direction, an index into detail::DELTAS, fills the low bits
+    std::uint64_t moveKey(int from, int to, int step) const {
+        int delta = to - from;
+        std::uint64_t direction = delta == -1 ? 0 : delta == 1 ? 1 : delta == -cols ? 2 : 3;
+        return cellKey(to, step) << 2 | direction;
+    }
+
+    void noteStep(int cell, int step) {
+        int& last = lastSteps.emplace(cell, -1).first->second;
+        last = std::max(last, step);
+        lastStep = std::max(lastStep, step);
+    }
+};
+
+namespace detail {
+
+// Space-time A* for one agent. Keeps its buffers between plans.
+class SpaceTimeSearch {
+public:
+    // Finds the cheapest path from the agent's start that keeps out of the
+    // table and ends resting at its goal, with one cell per step. field must
+    // lead to the agent's goal. Among equally cheap paths it prefers the one
+    // that runs into the fewest reservations of avoid, if given. Returns
+    // false if there is none.
+    bool plan(const Grid& grid, const Agent& agent, const FlowField& field, const ReservationTable& table,
+              std::vector<Cell>& path, int& cost, int& expansions, const ReservationTable* avoid = nullptr) {
+        nodes.clear();
+        heap.clear();
+        bestG.clear();
+        closed.clear();
+        path.clear();
+        int start = grid.index(agent.start);
+        int goal = grid.index(agent.goal);
+        int goalReserved = table.lastReserved(goal);
+        if (!grid.passable(start) || !field.reachable(agent.start) || goalReserved == INT_MAX ||
+            !table.cellFree(start, 0)) {
+            return false;
+        }
+        int lastStep = std::max(table.horizon(), avoid ? avoid->horizon() : -1) + 1;
+        nodes.push_back(Node{start, 0, 0, 0, -1});
+        heap.push(nodeKey(field.distance(agent.start), 0, 0), 0);
+        while (!heap.empty()) {
+            int current = heap.pop();
+            Node node = nodes[current];
+            if (!closed.insert(stateKey(node.cell, std::min(node.step, lastStep))).second) {
+                continue; // Stale heap entry
+            }
+            ++expansions;
+            if (node.cell == goal && node.step > goalReserved) {
+                for (int n = current; n >= 0; n = nodes[n].parent) {
+                    path.push_back(grid.cellAt(nodes[n].cell));
+                }
+                std::reverse(path.begin(), path.end());
+                cost = node.g;
+                return true;
+            }
+            Cell cell = grid.cellAt(node.cell);
+            int step = node.step + 1;
+            // Move -1 waits in place
+            for (int move = -1; move < 4; ++move) {
+                int next = node.cell;
+                if (move >= 0) {
+                    Cell neighbor{cell.row + DELTAS[move].row, cell.col + DELTAS[move].col};
+                    if (!grid.contains(neighbor)) {
+                        continue;
+                    }
+                    next = grid.index(neighbor);
+                    if (!grid.passable(next) || !table.moveFree(node.cell, next, step)) {
+                        continue;
+                    }
+                }
+                Cell nextCell = grid.cellAt(next);
+                if (!table.cellFree(next, step) || !field.reachable(nextCell)) {
+                    continue;
+                }
+                std::uint64_t key = stateKey(next, std::min(step, lastStep));
+                int g = node.g + grid.cost(next);
+                int collisions = node.collisions;
+                if (avoid) {
+                    collisions += (avoid->cellFree(next, step) ? 0 : 1) +
+                                  (move >= 0 && !avoid->moveFree(node.cell, next, step) ? 1 : 0);
+                }
+                auto best = bestG.emplace(key, Best{g, collisions});
+                if (!best.second) {
+                    Best& known = best.first->second;
+                    if (known.g < g || (known.g == g && known.collisions <= collisions)) {
+                        continue;
+                    }
+                    known = Best{g, collisions};
+                }
+                nodes.push_back(Node{next, step, g, collisions, current});
+                heap.push(nodeKey(g + field.distance(nextCell), g, collisions), static_cast<int>(nodes.size()) - 1);
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Node {
+        int cell;
+        int step;
+        int g;
+        int collisions; // With the reservations to avoid, along the way here
+        int parent;
+    };
+
+    struct Best {
+        int g;
+        int collisions;
+    };
+
+    std::vector<Node> nodes;
+    QuaternaryHeap heap;
+    std::unordered_map<std::uint64_t, Best> bestG;
+    std::unordered_set<std::uint64_t> closed;
+
+    // Orders on f, then on fewer collisions, then on the larger g as
+    // priorityKey() does; the last two only break ties, so they are clamped
+    static std::uint64_t nodeKey(int f, int g, int collisions) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(f)) << 32 |
+               static_cast<std::uint64_t>(std::min(collisions, 0xffff)) << 16 |
+               (0xffff - std::min(g, 0xffff));
+    }
+
+    static std::uint64_t stateKey(int cell, int step) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(step)) << 32 | static_cast<std::uint32_t>(cell);
+    }
+};
+
+// The earliest conflict among the paths, and how many there are in all.
+// occupants holds the agent in each cell at the current and the previous
+// step, -1 where there is none; it is sized on first use and left all -1.
+inline int scanConflicts(const Grid& grid, const std::vector<const std::vector<Cell>*>& paths,
+                         AgentConflict& first, std::vector<int>& occupants) {
+    first = AgentConflict();
+    int makespan = 0;
+    for (const std::vector<Cell>* path : paths) {
+        makespan = std::max(makespan, static_cast<int>(path->size()) - 1);
+    }
+    size_t cellCount = grid.cellCount();
+    if (occupants.size() != 2 * cellCount) {
+        occupants.assign(2 * cellCount, -1);
+    }
+    int agentCount = static_cast<int>(paths.size());
+    int count = 0;
+    for (int step = 0; step <= makespan; ++step) {
+        int* now = &occupants[(step & 1) * cellCount];
+        int* before = &occupants[((step + 1) & 1) * cellCount];
+        for (int agent = 0; agent < agentCount; ++agent) {
+            const Cell& cell = positionAt(*paths[agent], step);
+            int index = grid.index(cell);
+            if (now[index] >= 0) {
+                if (++count == 1) {
+                    first = AgentConflict{now[index], agent, step, cell, cell, false};
+                }
+                continue;
+            }
+            now[index] = agent;
+            if (step == 0) {
+                continue;
+            }
+            // Two agents swap cells when the one that stood here last step
+            // now stands where this one came from; each pair is met twice
+            const Cell& from = positionAt(*paths[agent], step - 1);
+            int other = before[index];
+            if (from != cell && other >= 0 && other < agent && positionAt(*paths[other], step) == from) {
+                if (++count == 1) {
+                    first = AgentConflict{agent, other, step, cell, from, true};
+                }
+            }
+        }
+        if (step > 0) {
+            for (int agent = 0; agent < agentCount; ++agent) {
+                before[grid.index(positionAt(*paths[agent], step - 1))] = -1;
+            }
+        }
+    }
+    for (int agent = 0; agent < agentCount; ++agent) {
+        occupants[(makespan & 1) * cellCount + grid.index(positionAt(*paths[agent], makespan))] = -1;
+    }
+    return count;
+}
+
+inline void finishPlan(MultiAgentPlan& plan) {
+    plan.cost = 0;
+    plan.makespan = 0;
+    for (size_t agent = 0; agent < plan.paths.size(); ++agent) {
+        plan.cost += plan.costs[agent];
+        plan.makespan = std::max(plan.makespan, static_cast<int>(plan.paths[agent].size()) - 1);
+    }
+}
+
+// One branch of the CBS tree: the constraint it adds on top of its parent's,
+// and the path its constrained agent got under all of them
+struct ConflictNode {
+    int parent = -1;
+    int agent = -1; // -1 for the root, which holds every agent's first path
+    int cell = 0;
+    int from = -1; // -1 keeps the agent out of the cell, otherwise off the move from it
+    int step = 0;  // -1 adds no constraint, only a better path (a bypass)
+    std::vector<Cell> path;
+    int pathCost = 0;
+    int cost = 0; // Sum over the agents
+    int conflicts = 0;
+    AgentConflict firstConflict;
+};
+
+} // namespace detail
+
+// The first conflict in a set of paths, first < 0 if they have none
+inline AgentConflict findConflict(const Grid& grid, const std::vector<std::vector<Cell>>& paths) {
+    std::vector<const std::vector<Cell>*> pointers;
+    for (const std::vector<Cell>& path : paths) {
+        pointers.push_back(&path);
+    }
+    AgentConflict conflict;
+    std::vector<int> occupants;
+    detail::scanConflicts(grid, pointers, conflict, occupants);
+    return conflict;
+}
+
+// Plans all agents at once. The grid must not change meanwhile. Agents that
+// share a start or a goal have no plan. Once CBS has expanded nodeLimit plans
+// without finding one it sets limitReached and falls back to Cooperative A*,
+// so found then says only whether that plan succeeded. Throws
+// std::out_of_range if an agent's start or goal lies outside the grid.
+inline MultiAgentPlan planAgents(const Grid& grid, const std::vector<Agent>& agents, MultiAgentSolver solver,
+                                 ThreadPool& pool, int nodeLimit = CBS_NODE_LIMIT) {
+    std::unordered_set<int> starts;
+    std::unordered_set<int> goals;
+    bool distinct = true;
+    for (const Agent& agent : agents) {
+        if (!grid.contains(agent.start) || !grid.contains(agent.goal)) {
+            throw std::out_of_range("agent start or goal lies outside the grid");
+        }
+        distinct = starts.insert(grid.index(agent.start)).second && goals.insert(grid.index(agent.goal)).second &&
+                   distinct;
+    }
+    MultiAgentPlan plan;
+    int agentCount = static_cast<int>(agents.size());
+    if (!distinct || agents.empty()) {
+        plan.found = distinct;
+        return plan;
+    }
+
+    // One field per agent, for the estimates
+    std::vector<std::unique_ptr<FlowField>> fields(agentCount);
+    pool.parallelFor(agentCount, 1, [&](int begin, int end, int) {
+        for (int agent = begin; agent < end; ++agent) {
+            fields[agent].reset(new FlowField(grid, agents[agent].goal));
+        }
+    });
+    std::vector<detail::SpaceTimeSearch> searches(pool.size());
+
+    // Cooperative A*, also the fallback once CBS reaches its node limit
+    auto planInOrder = [&]() {
+        ReservationTable table(grid);
+        plan.paths.assign(agentCount, std::vector<Cell>());
+        plan.costs.assign(agentCount, 0);
+        for (int agent = 0; agent < agentCount; ++agent) {
+            if (!searches[0].plan(grid, agents[agent], *fields[agent], table, plan.paths[agent], plan.costs[agent],
+                                  plan.expansions)) {
+                plan.paths.clear();
+                plan.costs.clear();
+                return;
+            }
+            table.reservePath(plan.paths[agent]);
+        }
+        plan.found = true;
+        detail::finishPlan(plan);
+    };
+    if (solver == MultiAgentSolver::Cooperative) {
+        planInOrder();
+        return plan;
+    }
+
+    std::vector<detail::ConflictNode> nodes(1);
+    std::vector<std::vector<Cell>> rootPaths(agentCount);
+    std::vector<int> rootCosts(agentCount, 0);
+    std::vector<int> expansions(pool.size(), 0);
+    std::vector<char> planned(agentCount, 0);
+    pool.parallelFor(agentCount, 1, [&](int begin, int end, int thread) {
+        ReservationTable none(grid);
+        for (int agent = begin; agent < end; ++agent) {
+            planned[agent] = searches[thread].plan(grid, agents[agent], *fields[agent], none, rootPaths[agent],
+                                                   rootCosts[agent], expansions[thread]);
+        }
+    });
+    for (int thread = 0; thread < pool.size(); ++thread) {
+        plan.expansions += expansions[thread];
+        expansions[thread] = 0;
+    }
+    if (std::find(planned.begin(), planned.end(), 0) != planned.end()) {
+        return plan; // Some agent cannot reach its goal even alone
+    }
+
+    // The paths in effect at a node: the nearest replan of each agent up the
+    // tree, or its first path
+    auto pathsAt = [&](int node, std::vector<const std::vector<Cell>*>& paths, std::vector<int>* costs) {
+        paths.assign(agentCount, nullptr);
+        for (int n = node; nodes[n].agent >= 0; n = nodes[n].parent) {
+            if (!paths[nodes[n].agent]) {
+                paths[nodes[n].agent] = &nodes[n].path;
+                if (costs) {
+                    (*costs)[nodes[n].agent] = nodes[n].pathCost;
+                }
+            }
+        }
+        for (int agent = 0; agent < agentCount; ++agent) {
+            if (!paths[agent]) {
+                paths[agent] = &rootPaths[agent];
+                if (costs) {
+                    (*costs)[agent] = rootCosts[agent];
+                }
+            }
+        }
+    };
+
+    std::vector<const std::vector<Cell>*> paths;
+    pathsAt(0, paths, nullptr);
+    for (int agent = 0; agent < agentCount; ++agent) {
+        nodes[0].cost += rootCosts[agent];
+    }
+    std::vector<std::vector<int>> occupants(pool.size());
+    nodes[0].conflicts = detail::scanConflicts(grid, paths, nodes[0].firstConflict, occupants[0]);
+
+    // Ordered on the sum of costs, then on the number of conflicts
+    auto nodeKey = [&](int node) {
+        return static_cast<std::uint64_t>(nodes[node].cost) << 32 | static_cast<std::uint32_t>(nodes[node].conflicts);
+    };
+    QuaternaryHeap open;
+    open.push(nodeKey(0), 0);
+    detail::ConflictNode children[2];
+    bool childPlanned[2];
+    while (!open.empty() && plan.conflictNodes < nodeLimit) {
+        int node = open.pop();
+        ++plan.conflictNodes;
+        if (nodes[node].conflicts == 0) {
+            std::vector<int> costs(agentCount, 0);
+            pathsAt(node, paths, &costs);
+            plan.found = true;
+            for (int agent = 0; agent < agentCount; ++agent) {
+                plan.paths.push_back(*paths[agent]);
+            }
+            plan.costs = costs;
+            detail::finishPlan(plan);
+            return plan;
+        }
+
+        // Each child keeps one of the two agents out of the conflict
+        const AgentConflict& conflict = nodes[node].firstConflict;
+        pool.parallelFor(2, 1, [&](int begin, int end, int thread) {
+            for (int side = begin; side < end; ++side) {
+                detail::ConflictNode& child = children[side];
+                child = detail::ConflictNode();
+                child.parent = node;
+                child.agent = side == 0 ? conflict.first : conflict.second;
+                child.step = conflict.step;
+                if (!conflict.swap) {
+                    child.cell = grid.index(conflict.cell);
+                } else if (side == 0) {
+                    child.cell = grid.index(conflict.cell);
+                    child.from = grid.index(conflict.from);
+                } else {
+                    child.cell = grid.index(conflict.from);
+                    child.from = grid.index(conflict.cell);
+                }
+
+                ReservationTable constraints(grid);
+                for (const detail::ConflictNode* n = &child; n->agent >= 0; n = &nodes[n->parent]) {
+                    if (n->agent != child.agent || n->step < 0) {
+                        continue;
+                    }
+                    if (n->from < 0) {
+                        constraints.reserveCell(n->cell, n->step);
+                    } else {
+                        constraints.blockMove(n->from, n->cell, n->step);
+                    }
+                }
+                // The replan steers clear of the other agents where it can
+                // at no extra cost, which leaves fewer conflicts to branch on
+                std::vector<const std::vector<Cell>*> childPaths;
+                std::vector<int> costs(agentCount, 0);
+                pathsAt(node, childPaths, &costs);
+                ReservationTable others(grid);
+                size_t steps = 0;
+                for (int agent = 0; agent < agentCount; ++agent) {
+                    steps += agent != child.agent ? childPaths[agent]->size() : 0;
+                }
+                others.reserve(steps);
+                for (int agent = 0; agent < agentCount; ++agent) {
+                    if (agent != child.agent) {
+                        others.reservePath(*childPaths[agent]);
+                    }
+                }
+                childPlanned[side] = searches[thread].plan(grid, agents[child.agent], *fields[child.agent],
+                                                           constraints, child.path, child.pathCost,
+                                                           expansions[thread], &others);
+                if (!childPlanned[side]) {
+                    continue;
+                }
+                childPaths[child.agent] = &child.path;
+                child.cost = nodes[node].cost - costs[child.agent] + child.pathCost;
+                child.conflicts = detail::scanConflicts(grid, childPaths, child.firstConflict, occupants[thread]);
+            }
+        });
+        // A replan that costs no more and conflicts less is just as good a
+        // path under the node's own constraints, so it replaces the node
+        // instead of branching
+        int bypass = -1;
+        for (int side = 0; side < 2 && bypass < 0; ++side) {
+            if (childPlanned[side] && children[side].cost == nodes[node].cost &&
+                children[side].conflicts < nodes[node].conflicts) {
+                bypass = side;
+                children[side].step = -1;
+            }
+        }
+        for (int side = 0; side < 2; ++side) {
+            if (childPlanned[side] && (bypass < 0 || bypass == side)) {
+                nodes.push_back(std::move(children[side]));
+                open.push(nodeKey(static_cast<int>(nodes.size()) - 1), static_cast<int>(nodes.size()) - 1);
+            }
+        }
+        for (int thread = 0; thread < pool.size(); ++thread) {
+            plan.expansions += expansions[thread];
+            expansions[thread] = 0;
+        }
+    }
+    if (!open.empty()) {
+        plan.limitReached = true;
+        planInOrder();
+    }
+    return plan;
+}
+
+// The same on a pool of its own; threadCount 0 uses one thread per hardware
+// thread
+inline MultiAgentPlan planAgents(const Grid& grid, const std::vector<Agent>& agents, MultiAgentSolver solver,
+                                 int threadCount = 0, int nodeLimit = CBS_NODE_LIMIT) {
+    ThreadPool pool(threadCount);
+    return planAgents(grid, agents, solver, pool, nodeLimit);
+}
+
+} // namespace pathfinder
@@ -0,0 +1,97 @@
+#pragma once
+
+// Open list for the best-first searches: a 4-ary min-heap of (key, cell)
+// entries. Four children per node halve the depth of a binary heap and keep
+// each sift-down comparison within one or two cache lines.
+//
+// The heap has no decrease-key. When a search finds a cheaper way to a cell it
+// pushes a second entry and skips the older one when it is popped, which is
+// cheaper than tracking heap positions per cell.
+
+#include <cstdint>
+#include <vector>
+
+namespace pathfinder {
+
+// Orders on f first and, among equal f, prefers the larger g: the entry that is
+// deeper along its path is closer to the goal, so ties stop fanning out across
+// the whole band of equally good cells on open maps.
+inline std::uint64_t priorityKey(int f, int g = 0) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(f)) << 32) |
+           static_cast<std::uint32_t>(~static_cast<std::uint32_t>(g));
+}
+
+class QuaternaryHeap {
+public:
+    bool empty() const { return entries.empty(); }
+    size_t size() const { return entries.size(); }
+    void clear() { entries.clear(); }
+    void reserve(size_t capacity) { entries.reserve(capacity); }
+    size_t memoryUsage() const { return entries.capacity() * sizeof(Entry); }
+
+    void push(std::uint64_t key, int index) {
+        entries.push_back(Entry{key, index});
+        siftUp(entries.size() - 1);
+    }
+
+    // Removes the entry with the smallest key and returns its cell index
+    int pop() {
+        int index = entries.front().index;
+        entries.front() = entries.back();
+        entries.pop_back();
+        if (!entries.empty()) {
+            siftDown(0);
+        }
+        return index;
+    }
+
+    std::uint64_t topKey() const { return entries.front().key; }
+    int topIndex() const { return entries.front().index; }
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        int index;
+    };
+
+    std::vector<Entry> entries;
+
+    void siftUp(size_t position) {
+        Entry entry = entries[position];
+        while (position > 0) {
+            size_t parent = (position - 1) / 4;
+            if (entries[parent].key <= entry.key) {
+                break;
+            }
+            entries[position] = entries[parent];
+            position = parent;
+        }
+        entries[position] = entry;
+    }
+
+    void siftDown(size_t position) {
+        Entry entry = entries[position];
+        size_t count = entries.size();
+        while (true) {
+            size_t first = position * 4 + 1;
+            if (first >= count) {
+                break;
+            }
+            size_t last = first + 4 < count ? first + 4 : count;
+            size_t best = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (entries[child].key < entries[best].key) {
+                    best = child;
+                }
+            }
+            if (entries[best].key >= entry.key) {
+                break;
+            }
+            entries[position] = entries[best];
+            position = best;
+        }
+        entries[position] = entry;
+    }
+};
+
+} // namespace pathfinder
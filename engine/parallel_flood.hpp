@@ -0,0 +1,307 @@
+#pragma once
+
+// One-to-all distances on a ThreadPool, for sweeps over maps too large for
+// the single-threaded flood in flow_field.hpp. Both algorithms compute the
+// exact distances that flood settles.
+//
+// Uniform-cost four-connected grids get a level-synchronous breadth-first
+// search: every level expands the whole frontier in parallel. It switches
+// direction with the frontier's size. While the frontier is small it runs
+// top-down, each frontier cell claiming its unvisited neighbors with an
+// atomic bit operation on the visited bitboard. Once the frontier is large
+// compared to the rows it spans it runs bottom-up: each row of the span
+// finds its unvisited open cells next to the frontier with shifts and masks,
+// a WordVector at a time (detail::expandRow()) and without atomics, as every
+// row is written by one thread only.
+//
+// Weighted grids and eight-connected movement get delta-stepping. Cells wait
+// in buckets of distance width delta; the lowest bucket is emptied in
+// parallel rounds that relax the steps no longer than delta (which may add
+// cells back to it), then the longer steps out of every cell it held are
+// relaxed once. Distances only ever drop, by an atomic compare-and-swap, so
+// the order in which threads relax a cell does not matter.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bitboard.hpp"
+#include "grid.hpp"
+#include "movement.hpp"
+#include "search_space.hpp"
+#include "thread_pool.hpp"
+
+namespace pathfinder {
+
+// Frontier cells a thread takes at a time
+const int PARALLEL_FLOOD_GRAIN = 1024;
+
+namespace detail {
+
+// Atomic access to bitboard words that the bottom-up step reads and writes
+// plainly; the pool's barrier between the two steps orders them
+inline std::uint64_t atomicLoad(const std::uint64_t& word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&word, __ATOMIC_RELAXED);
+#else
+    return reinterpret_cast<const std::atomic<std::uint64_t>&>(word).load(std::memory_order_relaxed);
+#endif
+}
+
+inline std::uint64_t atomicOr(std::uint64_t& word, std::uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_fetch_or(&word, mask, __ATOMIC_RELAXED);
+#else
+    return reinterpret_cast<std::atomic<std::uint64_t>&>(word).fetch_or(mask, std::memory_order_relaxed);
+#endif
+}
+
+// Level-synchronous breadth-first search from root over a uniform-cost grid
+// with four-connected movement
+inline std::vector<int> parallelBreadthFirst(const Grid& grid, int root, ThreadPool& pool) {
+    std::vector<int> distances(grid.cellCount(), SearchSpace::UNREACHED);
+    if (!grid.passable(root)) {
+        return distances;
+    }
+    BitBoard open = BitBoard::passability(grid);
+    int stride = open.stride();
+    int cols = grid.cols();
+    BitBoard visited(grid.rows(), cols);
+    BitBoard frontierBits(grid.rows(), cols);
+    std::vector<std::uint64_t> noFrontier(stride, 0); // Above the first row and below the last
+    auto word = [&](BitBoard& board, const Cell& cell) -> std::uint64_t& { return board.row(cell.row)[cell.col / 64]; };
+    auto bit = [](int col) { return static_cast<std::uint64_t>(1) << (col % 64); };
+
+    Cell rootCell = grid.cellAt(root);
+    visited.set(rootCell.row, rootCell.col);
+    distances[root] = 0;
+    std::vector<int> frontier(1, root);
+    std::vector<std::vector<int>> found(pool.size());
+    std::vector<std::vector<std::uint64_t>> reachedRows(pool.size(), std::vector<std::uint64_t>(stride));
+    std::vector<int> firstRows(pool.size());
+    std::vector<int> lastRows(pool.size());
+    int firstRow = rootCell.row;
+    int lastRow = rootCell.row;
+    for (int level = 1; !frontier.empty(); ++level) {
+        for (std::vector<int>& cells : found) {
+            cells.clear();
+        }
+        // Top-down checks four neighbors per frontier cell, bottom-up a word
+        // per 64 cells of the rows around the frontier
+        size_t spanWords = static_cast<size_t>(std::min(lastRow + 1, grid.rows() - 1) -
+                                               std::max(firstRow - 1, 0) + 1) * stride;
+        if (frontier.size() * 4 < spanWords) {
+            int count = static_cast<int>(frontier.size());
+            pool.parallelFor(count, PARALLEL_FLOOD_GRAIN, [&](int begin, int end, int thread) {
+                for (int i = begin; i < end; ++i) {
+                    Cell cell = grid.cellAt(frontier[i]);
+                    for (const Cell& delta : DELTAS) {
+                        Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+                        if (!grid.contains(neighbor) || !open.test(neighbor.row, neighbor.col)) {
+                            continue;
+                        }
+                        std::uint64_t& seen = word(visited, neighbor);
+                        std::uint64_t mask = bit(neighbor.col);
+                        if (atomicLoad(seen) & mask || atomicOr(seen, mask) & mask) {
+                            continue;
+                        }
+                        int next = neighbor.row * cols + neighbor.col;
+                        distances[next] = level;
+                        found[thread].push_back(next);
+                    }
+                }
+            });
+        } else {
+            pool.parallelFor(static_cast<int>(frontier.size()), PARALLEL_FLOOD_GRAIN, [&](int begin, int end, int) {
+                for (int i = begin; i < end; ++i) {
+                    Cell cell = grid.cellAt(frontier[i]);
+                    atomicOr(word(frontierBits, cell), bit(cell.col));
+                }
+            });
+            int first = std::max(firstRow - 1, 0);
+            int rows = std::min(lastRow + 1, grid.rows() - 1) - first + 1;
+            pool.parallelFor(rows, 1, [&](int begin, int end, int thread) {
+                std::uint64_t* reached = reachedRows[thread].data();
+                for (int row = first + begin; row < first + end; ++row) {
+                    const std::uint64_t* above = row > 0 ? frontierBits.row(row - 1) : noFrontier.data();
+                    const std::uint64_t* below = row + 1 < grid.rows() ? frontierBits.row(row + 1) : noFrontier.data();
+                    if (!expandRow(above, frontierBits.row(row), below, open.row(row), visited.row(row), reached,
+                                   stride)) {
+                        continue;
+                    }
+                    for (int w = 0; w < stride; ++w) {
+                        for (std::uint64_t bits = reached[w]; bits; bits &= bits - 1) {
+                            int next = row * cols + w * 64 + countTrailingZeros(bits);
+                            distances[next] = level;
+                            found[thread].push_back(next);
+                        }
+                    }
+                }
+            });
+            // The frontier lies in rows firstRow to lastRow
+            pool.parallelFor(lastRow - firstRow + 1, 1, [&](int begin, int end, int) {
+                for (int row = firstRow + begin; row < firstRow + end; ++row) {
+                    std::fill(frontierBits.row(row), frontierBits.row(row) + stride, 0);
+                }
+            });
+        }
+
+        frontier.clear();
+        firstRow = grid.rows();
+        lastRow = -1;
+        for (const std::vector<int>& cells : found) {
+            frontier.insert(frontier.end(), cells.begin(), cells.end());
+            if (!cells.empty()) {
+                firstRow = std::min(firstRow, *std::min_element(cells.begin(), cells.end()) / cols);
+                lastRow = std::max(lastRow, *std::max_element(cells.begin(), cells.end()) / cols);
+            }
+        }
+    }
+    return distances;
+}
+
+// Delta-stepping from root; with toRoot, distances of paths ending at root
+inline std::vector<int> deltaStepping(const Grid& grid, int root, const Movement& movement, bool toRoot,
+                                      ThreadPool& pool, int delta) {
+    std::vector<int> result(grid.cellCount(), SearchSpace::UNREACHED);
+    if (!grid.passable(root)) {
+        return result;
+    }
+    bool eightWays = movement.connectivity == Connectivity::Eight;
+    int moves = eightWays ? 8 : 4;
+    int sideLength = eightWays ? DISTANCE_UNIT : 1;
+    if (delta <= 0) {
+        // Wide enough that a step through a plain cell is light in either
+        // direction, narrow enough that buckets stay ordered on mud
+        delta = 2 * (eightWays ? DIAGONAL_STEP : sideLength);
+    }
+    int heaviest = Grid::MAX_COST * (eightWays ? DIAGONAL_STEP : sideLength);
+    // Buckets are reused cyclically: a relaxed cell lands at most this many
+    // buckets above the one being emptied
+    int bucketCount = heaviest / delta + 2;
+
+    size_t cells = grid.cellCount();
+    std::unique_ptr<std::atomic<int>[]> distances(new std::atomic<int>[cells]);
+    // The distance each cell last had its light steps relaxed at, so a cell
+    // queued twice at the same distance is relaxed once
+    std::unique_ptr<std::atomic<int>[]> relaxedAt(new std::atomic<int>[cells]);
+    pool.parallelFor(static_cast<int>(cells), 64 * PARALLEL_FLOOD_GRAIN, [&](int begin, int end, int) {
+        for (int i = begin; i < end; ++i) {
+            distances[i].store(SearchSpace::UNREACHED, std::memory_order_relaxed);
+            relaxedAt[i].store(-1, std::memory_order_relaxed);
+        }
+    });
+    distances[root].store(0, std::memory_order_relaxed);
+
+    std::vector<std::vector<int>> buckets(bucketCount);
+    buckets[0].push_back(root);
+    size_t queued = 1;
+    // Per thread: cells improved this round, and cells the bucket held
+    std::vector<std::vector<int>> improved(pool.size());
+    std::vector<std::vector<int>> settled(pool.size());
+    std::vector<int> round;
+
+    // Relaxes the light (heavy false) or heavy steps out of cells
+    auto relax = [&](const std::vector<int>& from, bool heavy, bool settle) {
+        pool.parallelFor(static_cast<int>(from.size()), PARALLEL_FLOOD_GRAIN, [&](int begin, int end, int thread) {
+            for (int i = begin; i < end; ++i) {
+                int current = from[i];
+                int distance = distances[current].load(std::memory_order_relaxed);
+                if (settle && relaxedAt[current].exchange(distance, std::memory_order_relaxed) == distance) {
+                    continue;
+                }
+                if (settle) {
+                    settled[thread].push_back(current);
+                }
+                Cell cell = grid.cellAt(current);
+                for (int move = 0; move < moves; ++move) {
+                    const Cell& step = MOVES[move];
+                    Cell neighbor{cell.row + step.row, cell.col + step.col};
+                    bool diagonal = move >= 4;
+                    if (!grid.contains(neighbor) ||
+                        (diagonal && !diagonalAllowed(grid, cell, step, movement.corners))) {
+                        continue;
+                    }
+                    int next = current + step.row * grid.cols() + step.col;
+                    if (!grid.passable(next)) {
+                        continue;
+                    }
+                    int weight = grid.cost(toRoot ? current : next) * (diagonal ? DIAGONAL_STEP : sideLength);
+                    if ((weight > delta) != heavy) {
+                        continue;
+                    }
+                    int newDistance = distance + weight;
+                    int old = distances[next].load(std::memory_order_relaxed);
+                    while (newDistance < old &&
+                           !distances[next].compare_exchange_weak(old, newDistance, std::memory_order_relaxed)) {
+                    }
+                    if (newDistance < old) {
+                        improved[thread].push_back(next);
+                    }
+                }
+            }
+        });
+    };
+    // Moves the improved cells into their buckets, counting the entries a
+    // cell leaves behind in a higher bucket as stale
+    auto fileImproved = [&]() {
+        for (std::vector<int>& cells : improved) {
+            for (int cell : cells) {
+                buckets[distances[cell].load(std::memory_order_relaxed) / delta % bucketCount].push_back(cell);
+                ++queued;
+            }
+            cells.clear();
+        }
+    };
+
+    for (int bucket = 0; queued > 0; ++bucket) {
+        std::vector<int>& current = buckets[bucket % bucketCount];
+        for (std::vector<int>& cells : settled) {
+            cells.clear();
+        }
+        while (!current.empty()) {
+            round.clear();
+            for (int cell : current) {
+                // Entries left behind when a cell moved to a lower bucket
+                if (distances[cell].load(std::memory_order_relaxed) / delta == bucket) {
+                    round.push_back(cell);
+                }
+            }
+            queued -= current.size();
+            current.clear();
+            relax(round, false, true);
+            fileImproved();
+        }
+        round.clear();
+        for (const std::vector<int>& cells : settled) {
+            round.insert(round.end(), cells.begin(), cells.end());
+        }
+        relax(round, true, false);
+        fileImproved();
+    }
+
+    pool.parallelFor(static_cast<int>(cells), 64 * PARALLEL_FLOOD_GRAIN, [&](int begin, int end, int) {
+        for (int i = begin; i < end; ++i) {
+            result[i] = distances[i].load(std::memory_order_relaxed);
+        }
+    });
+    return result;
+}
+
+} // namespace detail
+
+// Distances from root (or, with toRoot, of paths ending at root) to every
+// cell, SearchSpace::UNREACHED where there is no path, in the movement's
+// distance units; the same as detail::flood() settles. delta sets the bucket
+// width of delta-stepping, 0 picks one.
+inline std::vector<int> parallelFlood(const Grid& grid, int root, const Movement& movement, bool toRoot,
+                                      ThreadPool& pool, int delta = 0) {
+    if (movement.connectivity == Connectivity::Four && grid.uniformCost()) {
+        return detail::parallelBreadthFirst(grid, root, pool);
+    }
+    return detail::deltaStepping(grid, root, movement, toRoot, pool, delta);
+}
+
+} // namespace pathfinder
@@ -0,0 +1,464 @@
+#pragma once
+
+// A least-recently-used cache of found paths, for callers that ask the same
+// questions over and over: units re-planning towards one rally point, batches
+// with repeated pairs, a tool replaying a scenario. Entries are keyed by the
+// algorithm, the movement and the two endpoints, and belong to the grid
+// version they were found at.
+//
+// A query whose endpoints both lie on a cached path, start before goal, takes
+// that stretch of the path instead of searching, provided the path was found
+// by a search that always returns the cheapest path one cell at a time
+// (Dijkstra, A* with an admissible heuristic, JPS, JPS+, the bidirectional
+// searches and D* Lite): any stretch of such a path is itself a cheapest path
+// between its ends. Routes towards a shared goal thus answer every query that
+// starts somewhere along them.
+//
+// Every cell a cached path depends on, its own cells and the cells beside its
+// diagonal steps and any-angle segments, is indexed back to the entries that
+// use it. Before answering, the cache reads the grid's edit journal and drops
+// exactly the entries whose paths cross an edited cell. Cheapest paths can
+// also be undercut by a cell that opened up or got cheaper off the path, so
+// they are dropped too when the cell lies close enough that a detour through
+// it could beat them: when the movement's lower bound from start to the cell
+// plus the cell to goal is below the path's cost. Paths of the other searches
+// stay valid, if not what a new search would return. When the journal no
+// longer reaches back far enough the whole cache is dropped.
+//
+// One cache serves one grid; clear() it before using it with another. Every
+// call locks the cache, so threads may share one while the grid stays put.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "grid.hpp"
+#include "movement.hpp"
+#include "search.hpp"
+
+namespace pathfinder {
+
+const size_t PATH_CACHE_CAPACITY = 4096;
+
+struct PathCacheStats {
+    long long hits = 0;        // Same query as a cached one
+    long long stretchHits = 0; // Start and goal on a cached cheapest path
+    long long misses = 0;
+    long long invalidated = 0; // Dropped because an edit may have changed them
+    long long evicted = 0;     // Dropped, least recently used, to make room
+};
+
+namespace detail {
+
+// Searches whose paths step from cell to neighbor and always cost the least
+inline bool cheapestCellPaths(Algorithm algorithm, const Movement& movement) {
+    switch (algorithm) {
+        case Algorithm::Dijkstra:
+        case Algorithm::BidirectionalDijkstra:
+        case Algorithm::DStarLite:
+            return true;
+        case Algorithm::AStar:
+        case Algorithm::JumpPoint:
+        case Algorithm::JumpPointPlus:
+        case Algorithm::BidirectionalAStar:
+            // Manhattan distance overestimates diagonal steps
+            return movement.connectivity == Connectivity::Four || movement.heuristic != Heuristic::Manhattan;
+        default:
+            return false;
+    }
+}
+
+// Cheapest paths of the same shape serve each other's queries: 0 for side
+// steps only (D* Lite always moves so), 1 + the corner rule with diagonals
+inline int pathShape(Algorithm algorithm, const Movement& movement) {
+    if (algorithm == Algorithm::DStarLite || movement.connectivity == Connectivity::Four) {
+        return 0;
+    }
+    return 1 + static_cast<int>(movement.corners);
+}
+
+} // namespace detail
+
+class PathCache {
+public:
+    explicit PathCache(size_t capacity = PATH_CACHE_CAPACITY) : limit(capacity) {}
+
+    PathCache(const PathCache&) = delete;
+    PathCache& operator=(const PathCache&) = delete;
+
+    // The cached answer to the query, if there is one. Such a result has no
+    // expansions and no stats, since nothing was searched.
+    bool lookup(const Grid& grid, Algorithm algorithm, const Movement& movement, const Cell& start, const Cell& goal,
+                SearchResult& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!grid.contains(start) || !grid.contains(goal)) {
+            return false;
+        }
+        sync(grid);
+        Key key = makeKey(grid, algorithm, movement, start, goal);
+        auto found = slots.find(key);
+        if (found != slots.end()) {
+            touch(found->second);
+            result = entries[found->second].result;
+            result.expansions = 0;
+            result.stats = SearchStats();
+            ++counters.hits;
+            return true;
+        }
+        if (detail::cheapestCellPaths(algorithm, movement) &&
+            findStretch(grid, detail::pathShape(algorithm, movement), key.start, key.goal, result)) {
+            ++counters.stretchHits;
+            return true;
+        }
+        ++counters.misses;
+        return false;
+    }
+
+    // Remembers a found path for the grid as it is now; paths not found are
+    // not kept, since any edit could open one
+    void store(const Grid& grid, Algorithm algorithm, const Movement& movement, const Cell& start, const Cell& goal,
+               const SearchResult& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!result.found || limit == 0 || !grid.contains(start) || !grid.contains(goal)) {
+            return;
+        }
+        sync(grid);
+        Key key = makeKey(grid, algorithm, movement, start, goal);
+        auto found = slots.find(key);
+        if (found != slots.end()) {
+            drop(found->second);
+        }
+        if (slots.size() >= limit) {
+            drop(oldest);
+            ++counters.evicted;
+        }
+
+        int slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = static_cast<int>(entries.size());
+            entries.emplace_back();
+        }
+        Entry& entry = entries[slot];
+        entry.key = key;
+        entry.result = result;
+        entry.shape = detail::cheapestCellPaths(algorithm, movement) ? detail::pathShape(algorithm, movement) : -1;
+        entry.units = entry.shape < 0 ? 0 : pathUnits(grid, entry.shape, result.path);
+        forEachCell(entry.result.path, [&](int cell, int position) {
+            cells[cell].push_back(Occurrence{slot, position});
+        });
+        slots[key] = slot;
+        entry.older = newest;
+        entry.newer = -1;
+        if (newest >= 0) {
+            entries[newest].newer = slot;
+        } else {
+            oldest = slot;
+        }
+        newest = slot;
+    }
+
+    // Runs the query on the finder unless the cache can answer it, and
+    // remembers the answer
+    SearchResult findPath(PathFinder& finder, Algorithm algorithm, const Cell& start, const Cell& goal) {
+        SearchResult result;
+        if (lookup(finder.grid, algorithm, finder.movement, start, goal, result)) {
+            return result;
+        }
+        result = finder.findPath(algorithm, start, goal);
+        store(finder.grid, algorithm, finder.movement, start, goal, result);
+        return result;
+    }
+
+    // Drops the entries the grid's edits since the last call may have
+    // changed. Lookups and stores do this themselves; calling it after a
+    // burst of edits only frees their memory sooner.
+    void update(const Grid& grid) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sync(grid);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        reset();
+        cellCount = -1;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return slots.size();
+    }
+
+    size_t capacity() const { return limit; }
+
+    PathCacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+
+private:
+    struct Key {
+        int start;
+        int goal;
+        int mode; // Algorithm and movement
+
+        bool operator==(const Key& other) const {
+            return start == other.start && goal == other.goal && mode == other.mode;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            std::uint64_t h = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.start)) << 32) |
+                              static_cast<std::uint32_t>(key.goal);
+            h = (h ^ (h >> 29) ^ static_cast<std::uint64_t>(key.mode)) * 0xbf58476d1ce4e5b9ULL;
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    struct Entry {
+        Key key{-1, -1, 0};
+        SearchResult result;
+        int shape = -1; // detail::pathShape() of a cheapest path, -1 for other paths
+        long long units = 0; // A cheapest path's cost in its search's units (see movement.hpp)
+        int newer = -1;
+        int older = -1;
+    };
+
+    // A cell an entry depends on, and where on the path it lies: its index,
+    // or -1 for cells the path only passes beside or through mid-segment
+    struct Occurrence {
+        int slot;
+        int position;
+    };
+
+    static Key makeKey(const Grid& grid, Algorithm algorithm, const Movement& movement, const Cell& start,
+                       const Cell& goal) {
+        int mode = static_cast<int>(algorithm) << 8 | static_cast<int>(movement.connectivity) << 6 |
+                   static_cast<int>(movement.corners) << 3 | static_cast<int>(movement.heuristic);
+        return Key{grid.index(start), grid.index(goal), mode};
+    }
+
+    // Cheapest-path cost in the units searches compare: cost per side step,
+    // fixed-point with diagonal steps
+    static long long pathUnits(const Grid& grid, int shape, const std::vector<Cell>& path) {
+        long long units = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            bool diagonal = path[i].row != path[i - 1].row && path[i].col != path[i - 1].col;
+            int length = shape == 0 ? 1 : diagonal ? DIAGONAL_STEP : DISTANCE_UNIT;
+            units += static_cast<long long>(grid.cost(grid.index(path[i]))) * length;
+        }
+        return units;
+    }
+
+    // Never more than the cheapest path between the cells costs, since every
+    // cell costs at least 1
+    static long long lowerBound(int shape, const Cell& a, const Cell& b) {
+        return shape == 0 ? detail::manhattan(a, b) : detail::octile(a, b);
+    }
+
+    // Visits every cell the path depends on, with its position on the path
+    template <typename Visit>
+    void forEachCell(const std::vector<Cell>& path, Visit visit) const {
+        for (size_t i = 0; i < path.size(); ++i) {
+            visit(path[i].row * cols + path[i].col, static_cast<int>(i));
+            if (i == 0) {
+                continue;
+            }
+            const Cell& from = path[i - 1];
+            const Cell& to = path[i];
+            detail::traceLine(
+                from, to,
+                [&](int row, int col) {
+                    if ((row != from.row || col != from.col) && (row != to.row || col != to.col)) {
+                        visit(row * cols + col, -1);
+                    }
+                    return true;
+                },
+                [&](int row, int col, int otherRow, int otherCol) {
+                    visit(row * cols + col, -1);
+                    visit(otherRow * cols + otherCol, -1);
+                    return true;
+                });
+        }
+    }
+
+    // The stretch from start to goal of a cheapest path of the given shape
+    bool findStretch(const Grid& grid, int shape, int start, int goal, SearchResult& result) {
+        auto starts = cells.find(start);
+        auto goals = cells.find(goal);
+        if (starts == cells.end() || goals == cells.end()) {
+            return false;
+        }
+        for (const Occurrence& from : starts->second) {
+            if (from.position < 0 || entries[from.slot].shape != shape) {
+                continue;
+            }
+            for (const Occurrence& to : goals->second) {
+                if (to.slot != from.slot || to.position <= from.position) {
+                    continue;
+                }
+                touch(from.slot);
+                const std::vector<Cell>& path = entries[from.slot].result.path;
+                result = SearchResult();
+                result.found = true;
+                result.path.assign(path.begin() + from.position, path.begin() + to.position + 1);
+                // Summed as Search does, so the stretch costs what a search would report
+                for (size_t i = 1; i < result.path.size(); ++i) {
+                    const Cell& a = result.path[i - 1];
+                    const Cell& b = result.path[i];
+                    double length = a.row == b.row || a.col == b.col ? std::abs(b.row - a.row) + std::abs(b.col - a.col)
+                                                                     : std::hypot(b.row - a.row, b.col - a.col);
+                    result.distance += grid.cost(grid.index(b)) * length;
+                }
+                result.cost = static_cast<int>(std::lround(result.distance));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Catches up with the grid's edits; the lock is held
+    void sync(const Grid& grid) {
+        if (grid.cellCount() != cellCount || grid.cols() != cols) {
+            reset();
+            cellCount = grid.cellCount();
+            cols = grid.cols();
+            version = grid.version();
+            return;
+        }
+        if (grid.version() == version) {
+            return;
+        }
+        edited.clear();
+        if (slots.empty()) {
+            // Nothing to check
+        } else if (!grid.editsSince(version, edited)) {
+            counters.invalidated += static_cast<long long>(slots.size());
+            reset();
+        } else {
+            std::sort(edited.begin(), edited.end());
+            edited.erase(std::unique(edited.begin(), edited.end()), edited.end());
+            for (int cell : edited) {
+                invalidate(grid, cell);
+            }
+        }
+        version = grid.version();
+    }
+
+    void invalidate(const Grid& grid, int cell) {
+        auto found = cells.find(cell);
+        if (found != cells.end()) {
+            doomed.clear();
+            for (const Occurrence& occurrence : found->second) {
+                doomed.push_back(occurrence.slot);
+            }
+            std::sort(doomed.begin(), doomed.end());
+            doomed.erase(std::unique(doomed.begin(), doomed.end()), doomed.end());
+            for (int slot : doomed) {
+                drop(slot);
+                ++counters.invalidated;
+            }
+        }
+        if (!grid.passable(cell)) {
+            return;
+        }
+        // The cell may have opened up or got cheaper: a detour through it
+        // could undercut a cheapest path that passes close enough
+        Cell at = grid.cellAt(cell);
+        for (int slot = oldest; slot >= 0;) {
+            const Entry& entry = entries[slot];
+            int next = entry.newer;
+            if (entry.shape >= 0) {
+                Cell start = grid.cellAt(entry.key.start);
+                Cell goal = grid.cellAt(entry.key.goal);
+                if (lowerBound(entry.shape, start, at) + lowerBound(entry.shape, at, goal) < entry.units) {
+                    drop(slot);
+                    ++counters.invalidated;
+                }
+            }
+            slot = next;
+        }
+    }
+
+    void touch(int slot) {
+        if (slot == newest) {
+            return;
+        }
+        unlink(slot);
+        Entry& entry = entries[slot];
+        entry.older = newest;
+        entry.newer = -1;
+        entries[newest].newer = slot;
+        newest = slot;
+    }
+
+    void unlink(int slot) {
+        Entry& entry = entries[slot];
+        if (entry.newer >= 0) {
+            entries[entry.newer].older = entry.older;
+        } else {
+            newest = entry.older;
+        }
+        if (entry.older >= 0) {
+            entries[entry.older].newer = entry.newer;
+        } else {
+            oldest = entry.newer;
+        }
+    }
+
+    void drop(int slot) {
+        Entry& entry = entries[slot];
+        forEachCell(entry.result.path, [&](int cell, int) {
+            auto found = cells.find(cell);
+            if (found == cells.end()) {
+                return; // Already cleared on an earlier visit
+            }
+            std::vector<Occurrence>& list = found->second;
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [slot](const Occurrence& occurrence) { return occurrence.slot == slot; }),
+                       list.end());
+            if (list.empty()) {
+                cells.erase(found);
+            }
+        });
+        slots.erase(entry.key);
+        unlink(slot);
+        entry.key = Key{-1, -1, 0};
+        entry.result.path.clear(); // Keeps its capacity for the next entry in the slot
+        freeSlots.push_back(slot);
+    }
+
+    void reset() {
+        entries.clear();
+        freeSlots.clear();
+        slots.clear();
+        cells.clear();
+        newest = -1;
+        oldest = -1;
+    }
+
+    size_t limit;
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    std::vector<int> freeSlots;
+    std::unordered_map<Key, int, KeyHash> slots;
+    std::unordered_map<int, std::vector<Occurrence>> cells;
+    int newest = -1; // Most recently used entry; each links to the next older one
+    int oldest = -1;
+    int cellCount = -1;
+    int cols = 0;
+    std::uint32_t version = 0;
+    std::vector<int> edited;
+    std::vector<int> doomed;
+    PathCacheStats counters;
+};
+
+} // namespace pathfinder
@@ -0,0 +1,1227 @@
+#pragma once
+
+// Grid searches behind the visualizer. A query returns the path, its cost and
+// how many nodes were expanded; callers that want to watch the search pass a
+// SearchObserver, everyone else runs at machine speed.
+//
+// Every algorithm is a resumable Search: step() expands one node and returns,
+// so an interactive caller can spread a query over as many frames as it likes
+// while a batch caller just calls run().
+//
+// The bidirectional variants grow one frontier from each end and stop once
+// neither can still improve on the best meeting found so far, so a long query
+// on an open map touches roughly half the cells a one-sided search would.
+//
+// D* Lite keeps its search tree after it finishes: replan() feeds it the grid
+// edits made since and resumes, and the steps that follow repair only the
+// part of the tree those edits invalidated.
+//
+// Theta* and Lazy Theta* search the eight-connected grid but let a cell take
+// any cell it can see as its parent, so paths run at any angle and list only
+// the cells where they turn.
+//
+// Dijkstra, DFS, greedy best-first and A* share one search kernel, a member
+// template over the algorithm, the movement, the cost model and the
+// heuristic. A query picks its instantiation once, so the loop that pops and
+// expands cells runs over a constant move table with its open-list policy
+// (queue, stack or heap), step lengths and estimate all fixed at compile time.
+//
+// With a LandmarkTable (see landmarks.hpp), four-connected A* and greedy
+// best-first estimate with the larger of Manhattan distance and the landmark
+// bound, which on maps full of walls and detours expands a fraction of the
+// cells Manhattan distance alone does.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "components.hpp"
+#include "dstar_lite.hpp"
+#include "grid.hpp"
+#include "hpa.hpp"
+#include "jps.hpp"
+#include "landmarks.hpp"
+#include "movement.hpp"
+#include "open_list.hpp"
+#include "search_space.hpp"
+#include "stats.hpp"
+
+namespace pathfinder {
+
+enum class Algorithm {
+    Dijkstra,
+    DepthFirst,
+    GreedyBestFirst,
+    AStar,
+    JumpPoint,
+    JumpPointPlus,
+    BidirectionalDijkstra,
+    BidirectionalAStar,
+    Hierarchical,
+    DStarLite,
+    ThetaStar,
+    LazyThetaStar
+};
+
+inline const char* algorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::Dijkstra: return "Dijkstra";
+        case Algorithm::DepthFirst: return "DFS";
+        case Algorithm::GreedyBestFirst: return "Greedy Best-First";
+        case Algorithm::AStar: return "A*";
+        case Algorithm::JumpPoint: return "JPS";
+        case Algorithm::JumpPointPlus: return "JPS+";
+        case Algorithm::BidirectionalDijkstra: return "Bidirectional Dijkstra";
+        case Algorithm::BidirectionalAStar: return "Bidirectional A*";
+        case Algorithm::Hierarchical: return "HPA*";
+        case Algorithm::DStarLite: return "D* Lite";
+        case Algorithm::ThetaStar: return "Theta*";
+        case Algorithm::LazyThetaStar: return "Lazy Theta*";
+    }
+    return "";
+}
+
+// Short lowercase names for command lines and machine-readable output
+inline const char* algorithmId(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::Dijkstra: return "dijkstra";
+        case Algorithm::DepthFirst: return "dfs";
+        case Algorithm::GreedyBestFirst: return "greedy";
+        case Algorithm::AStar: return "astar";
+        case Algorithm::JumpPoint: return "jps";
+        case Algorithm::JumpPointPlus: return "jps+";
+        case Algorithm::BidirectionalDijkstra: return "bidijkstra";
+        case Algorithm::BidirectionalAStar: return "biastar";
+        case Algorithm::Hierarchical: return "hpa";
+        case Algorithm::DStarLite: return "dstarlite";
+        case Algorithm::ThetaStar: return "theta";
+        case Algorithm::LazyThetaStar: return "lazytheta";
+    }
+    return "";
+}
+
+const Algorithm ALGORITHMS[] = {
+    Algorithm::Dijkstra,
+    Algorithm::DepthFirst,
+    Algorithm::GreedyBestFirst,
+    Algorithm::AStar,
+    Algorithm::JumpPoint,
+    Algorithm::JumpPointPlus,
+    Algorithm::BidirectionalDijkstra,
+    Algorithm::BidirectionalAStar,
+    Algorithm::Hierarchical,
+    Algorithm::DStarLite,
+    Algorithm::ThetaStar,
+    Algorithm::LazyThetaStar
+};
+
+// Looks an algorithm up by algorithmId(); returns false for unknown names
+inline bool parseAlgorithm(const std::string& id, Algorithm& algorithm) {
+    for (Algorithm candidate : ALGORITHMS) {
+        if (id == algorithmId(candidate)) {
+            algorithm = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct SearchResult {
+    bool found = false;
+    // Start to goal, both included. Consecutive cells are neighbors, except
+    // on any-angle paths, which list only the start, the turns and the goal.
+    std::vector<Cell> path;
+    // Every step pays the cost of the cell it enters times the step's length:
+    // 1 for a side step, sqrt(2) diagonally, the segment's length at any
+    // angle. distance is that sum and cost the same rounded to an integer,
+    // which for four-connected paths is exact.
+    int cost = 0;
+    double distance = 0.0;
+    int expansions = 0;
+    SearchStats stats;
+};
+
+// Receives a callback every time a search reaches a new cell
+class SearchObserver {
+public:
+    virtual ~SearchObserver() = default;
+    virtual void onVisit(const Cell& cell) = 0;
+    // Cells reached by the goal-side frontier of a bidirectional search
+    virtual void onVisitFromGoal(const Cell& cell) { onVisit(cell); }
+};
+
+// Buffers a query works in besides its SearchSpace: the open lists, the
+// path, HPA*'s links and cluster searches and the D* Lite planner. A Search
+// clears what it uses but keeps the capacity, so queries sharing one scratch
+// (a PathFinder's, or a batch worker's) stop allocating once the buffers have
+// grown to fit; the path buffer comes back when the Search is destroyed. A
+// scratch serves one query at a time.
+struct SearchScratch {
+    // Uniform-cost Dijkstra uses cells as a FIFO queue, DFS as a stack;
+    // everything else keeps a heap of cells ordered by priorityKey()
+    struct Frontier {
+        std::vector<int> cells;
+        size_t head = 0;
+        QuaternaryHeap heap;
+
+        void clear() {
+            cells.clear();
+            head = 0;
+            heap.clear();
+        }
+    };
+
+    Frontier forward;
+    Frontier backward;
+    std::vector<Cell> path;
+    std::vector<AbstractEdge> startLinks;
+    std::vector<AbstractEdge> goalLinks;
+    std::vector<int> waypoints;
+    HierarchicalMap::ClusterScratch cluster;
+    std::unique_ptr<pathfinder::DStarLite> planner;
+};
+
+// Read-only tables built for one grid, which any number of queries and
+// threads can share. Each is optional; Search says what it is used for.
+struct SearchTables {
+    const JumpTable* jumpTable = nullptr;
+    const JumpScanner* jumpScanner = nullptr;
+    const HierarchicalMap* hierarchy = nullptr;
+    const ComponentMap* components = nullptr;
+    const LandmarkTable* landmarks = nullptr;
+};
+
+// One query in progress. The Search borrows the grid, the search space, the
+// tables and the scratch, so they must outlive it, and only one Search may use a
+// SearchSpace or SearchScratch at a time. Without a scratch it allocates one
+// of its own.
+//
+// Jump Point Search only holds on uniform-cost grids; on a weighted grid JPS
+// and JPS+ run as A*. JPS+ needs a JumpTable that is current for the grid and
+// runs as plain JPS without one. Plain JPS scans runs with a JumpScanner
+// when it gets a current one, and cell by cell otherwise.
+//
+// The bidirectional variants keep the goal side's state in a second search
+// space; without one they run as their one-sided counterparts.
+//
+// HPA* searches the abstract graph of a HierarchicalMap that is current for
+// the grid (A* runs without one). Its steps expand abstract nodes, and only
+// the finished path is refined into grid cells.
+//
+// D* Lite searches from the goal towards the start in a planner kept in the
+// scratch, reporting each expanded cell through onVisitFromGoal(), and can be resumed
+// with replan() after grid edits.
+//
+// The Movement picks four- or eight-connected steps, the corner rule and the
+// heuristic. Dijkstra, DFS, Greedy Best-First, A* and the bidirectional
+// variants follow it; JPS, JPS+ and HPA* run as A* when it allows diagonal
+// steps, and D* Lite always moves four ways. Theta* and Lazy Theta* always
+// move eight ways under its corner rule; they need a uniform-cost grid and
+// run as eight-connected A* on a weighted one.
+//
+// Given a ComponentMap that is current for the grid, a query whose start and
+// goal lie in different components finishes on its first step without
+// expanding anything. D* Lite ignores it, since its search is kept for later
+// edits that may connect the two, and so do diagonal moves that may cut
+// corners, which can join cells the labels keep apart.
+//
+// A LandmarkTable that is current for the grid tightens the estimate of
+// four-connected A* and greedy best-first, unless the Movement asks for
+// Manhattan distance. The other searches ignore it.
+class Search {
+public:
+    // Start and goal must lie inside the grid
+    Search(const Grid& grid, SearchSpace& space, Algorithm algorithm, const Cell& start, const Cell& goal,
+           SearchObserver* observer = nullptr, const SearchTables& tables = SearchTables(),
+           const Movement& movement = Movement(), SearchSpace* reverseSpace = nullptr,
+           SearchScratch* scratch = nullptr)
+        : grid(grid), space(space), reverseSpace(reverseSpace),
+          algorithm(effectiveAlgorithm(grid, algorithm, tables.jumpTable, reverseSpace, tables.hierarchy, movement)),
+          startIndex(grid.index(start)), goalIndex(grid.index(goal)), start(start), goal(goal),
+          movement(effectiveMovement(this->algorithm, movement, tables.landmarks && tables.landmarks->current(grid))),
+          unit(this->movement.connectivity == Connectivity::Four ? 1 : DISTANCE_UNIT),
+          observer(observer), jumpTable(tables.jumpTable), hierarchy(tables.hierarchy),
+          jumpScanner(tables.jumpScanner && tables.jumpScanner->current(grid) ? tables.jumpScanner : nullptr),
+          landmarks(this->movement.heuristic == Heuristic::Landmarks ? tables.landmarks : nullptr),
+          ownedScratch(scratch ? nullptr : new SearchScratch()), scratch(scratch ? *scratch : *ownedScratch),
+          forward(this->scratch.forward), backward(this->scratch.backward), startLinks(this->scratch.startLinks),
+          goalLinks(this->scratch.goalLinks), bidirectional(this->algorithm == Algorithm::BidirectionalDijkstra ||
+                        this->algorithm == Algorithm::BidirectionalAStar),
+          // Uniform side steps let Dijkstra expand in FIFO order; weighted maps
+          // and diagonal steps need a heap
+          fifo((this->algorithm == Algorithm::Dijkstra || this->algorithm == Algorithm::BidirectionalDijkstra) &&
+               grid.uniformCost() && this->movement.connectivity == Connectivity::Four),
+          finished(false), meetingIndex(-1), bestCost(SearchSpace::UNREACHED) {
+        kernel = selectKernel();
+        if (this->landmarks) {
+            this->landmarks->aim(goalIndex, landmarkGoal);
+        }
+        forward.clear();
+        backward.clear();
+        startLinks.clear();
+        goalLinks.clear();
+        searchResult.path.swap(this->scratch.path);
+        searchResult.path.clear();
+        if (this->algorithm == Algorithm::DStarLite) {
+            std::unique_ptr<pathfinder::DStarLite>& kept = this->scratch.planner;
+            if (kept && kept->plansOn(grid)) {
+                kept->restart(start, goal);
+            } else {
+                kept.reset(new pathfinder::DStarLite(grid, start, goal));
+            }
+            planner = kept.get();
+            return;
+        }
+        space.resize(grid.cellCount());
+        space.reset();
+        if (bidirectional) {
+            reverseSpace->resize(grid.cellCount());
+            reverseSpace->reset();
+        }
+        // A wall as start or goal can never be part of a path, and neither can
+        // endpoints in different components
+        const ComponentMap* components = tables.components;
+        bool labelsApply = components && components->current(grid) &&
+                           (this->movement.connectivity == Connectivity::Four ||
+                            this->movement.corners == CornerRule::NoCut);
+        bool reachable = grid.passable(startIndex) && grid.passable(goalIndex) &&
+                         (!labelsApply || components->connected(startIndex, goalIndex));
+        if (reachable) {
+            space.open(startIndex, 0, -1);
+            push(forward, startIndex, priorityKey(bidirectional ? bidirectionalKey(start, 0, false)
+                                                                : heuristic(start, goal)));
+            if (bidirectional) {
+                reverseSpace->open(goalIndex, 0, -1);
+                push(backward, goalIndex, priorityKey(bidirectionalKey(goal, 0, true)));
+                if (startIndex == goalIndex) {
+                    meetingIndex = goalIndex;
+                    bestCost = 0;
+                }
+            }
+            if (this->algorithm == Algorithm::Hierarchical) {
+                connectEndpoints();
+            }
+        }
+    }
+
+    // A Search points into its scratch, so it stays where it was created
+    Search(const Search&) = delete;
+    Search& operator=(const Search&) = delete;
+
+    ~Search() { scratch.path.swap(searchResult.path); }
+
+    bool done() const { return finished; }
+    const SearchResult& result() const { return searchResult; }
+
+    // Expands one node. Returns false once the search has finished, either
+    // because the goal was reached or because the open list ran dry.
+    bool step() {
+        if (bidirectional) {
+            return stepBidirectional();
+        }
+        if (planner) {
+            return stepIncremental();
+        }
+        if (kernel) {
+            return (this->*kernel)();
+        }
+
+        int current;
+        while (true) {
+            if (openEmpty(forward)) {
+                finished = true;
+                return false;
+            }
+            current = pop(forward);
+            // A cell may have been pushed more than once; only the first
+            // (cheapest) entry popped is expanded
+            if (!space.closed(current)) {
+                break;
+            }
+            if (STATS_ENABLED) {
+                ++searchResult.stats.stalePops;
+            }
+        }
+
+        ++searchResult.expansions;
+        space.close(current);
+        if (algorithm == Algorithm::LazyThetaStar) {
+            settleParent(current);
+        }
+
+        if (current == goalIndex) {
+            buildPath(goalIndex);
+            finished = true;
+            return false;
+        }
+
+        expand(current);
+        return true;
+    }
+
+    // Expands up to maxExpansions nodes and returns how many were expanded
+    int advance(int maxExpansions) {
+        int expanded = 0;
+        while (expanded < maxExpansions && step()) {
+            ++expanded;
+        }
+        return expanded;
+    }
+
+    const SearchResult& run() {
+        while (step()) {
+        }
+        return searchResult;
+    }
+
+    // D* Lite only: picks up the grid edits made since the last (re)plan and a
+    // start that may have moved along the path, then resumes the search, so
+    // the following steps repair the previous result. The result and its
+    // counters then describe the repair alone. Returns false for every other
+    // algorithm, which has to start a new Search instead.
+    bool replan(const Cell& newStart) {
+        if (!planner) {
+            return false;
+        }
+        planner->update();
+        if (newStart != planner->startCell()) {
+            planner->moveStart(newStart);
+            start = newStart;
+            startIndex = grid.index(newStart);
+        }
+        planner->resetStats();
+        std::vector<Cell> path = std::move(searchResult.path); // Keeps its capacity
+        searchResult = SearchResult();
+        searchResult.path = std::move(path);
+        finished = false;
+        return true;
+    }
+
+    // Bytes held by the buffers this query works in: the search spaces, the
+    // open lists at their largest so far, and the JPS+ or landmark tables if
+    // it uses them
+    size_t memoryUsage() const {
+        if (planner) {
+            return planner->memoryUsage();
+        }
+        size_t bytes = space.memoryUsage() + frontierMemory(forward);
+        if (bidirectional) {
+            bytes += reverseSpace->memoryUsage() + frontierMemory(backward);
+        }
+        if (algorithm == Algorithm::JumpPointPlus) {
+            bytes += jumpTable->memoryUsage();
+        }
+        if (algorithm == Algorithm::JumpPoint && jumpScanner) {
+            bytes += jumpScanner->memoryUsage();
+        }
+        if (landmarks) {
+            bytes += landmarks->memoryUsage();
+        }
+        if (algorithm == Algorithm::Hierarchical) {
+            bytes += hierarchy->memoryUsage() + (startLinks.capacity() + goalLinks.capacity()) * sizeof(AbstractEdge) +
+                     scratch.waypoints.capacity() * sizeof(int) + scratch.cluster.memoryUsage();
+        }
+        return bytes;
+    }
+
+private:
+    enum class OpenOrder { Queue, Stack, Heap };
+
+    using Frontier = SearchScratch::Frontier;
+
+    const Grid& grid;
+    SearchSpace& space;
+    SearchSpace* reverseSpace; // Goal side of a bidirectional search
+    Algorithm algorithm;
+    int startIndex;
+    int goalIndex;
+    Cell start;
+    Cell goal;
+    Movement movement;
+    int unit; // Length of a side step in distance units
+    SearchObserver* observer;
+    const JumpTable* jumpTable;
+    const HierarchicalMap* hierarchy;
+    const JumpScanner* jumpScanner;
+    const LandmarkTable* landmarks; // Only while the heuristic uses it
+    LandmarkTable::Goal landmarkGoal;
+    std::unique_ptr<SearchScratch> ownedScratch; // Only if the caller passed none
+    SearchScratch& scratch;
+    Frontier& forward;
+    Frontier& backward;
+    // HPA* joins start and goal to the abstract graph through these: costs
+    // from the start to its cluster's nodes, and from the goal cluster's
+    // nodes to the goal
+    std::vector<AbstractEdge>& startLinks;
+    std::vector<AbstractEdge>& goalLinks;
+    int goalCluster = -1;
+    pathfinder::DStarLite* planner = nullptr; // Kept in the scratch
+    SearchResult searchResult;
+    bool bidirectional;
+    bool fifo;
+    bool finished;
+    // Cheapest start-to-goal path through a cell both sides have reached
+    int meetingIndex;
+    int bestCost;
+    // step() for the algorithms that run on the search kernel, else nullptr
+    using Kernel = bool (Search::*)();
+    Kernel kernel = nullptr;
+
+    // The kernel has its own open list operations with the order fixed;
+    // these serve the other searches
+    bool openEmpty(const Frontier& frontier) const {
+        if (fifo) {
+            return frontier.head == frontier.cells.size();
+        }
+        return frontier.heap.empty();
+    }
+
+    size_t openSize(const Frontier& frontier) const {
+        if (fifo || algorithm == Algorithm::DepthFirst) {
+            return frontier.cells.size() - frontier.head;
+        }
+        return frontier.heap.size();
+    }
+
+    static size_t frontierMemory(const Frontier& frontier) {
+        return frontier.cells.capacity() * sizeof(int) + frontier.heap.memoryUsage();
+    }
+
+    // Also seeds the kernel's open list with the start
+    void push(Frontier& frontier, int index, std::uint64_t key) {
+        if (fifo || algorithm == Algorithm::DepthFirst) {
+            frontier.cells.push_back(index);
+        } else {
+            frontier.heap.push(key, index);
+        }
+        if (STATS_ENABLED) {
+            SearchStats& stats = searchResult.stats;
+            ++stats.pushes;
+            int openEntries = static_cast<int>(openSize(forward) + (bidirectional ? openSize(backward) : 0));
+            stats.maxOpenSize = std::max(stats.maxOpenSize, openEntries);
+        }
+    }
+
+    // Called before opening a cell; counts it if it already had a distance
+    void countReopening(const SearchSpace& frontierSpace, int index) {
+        if (STATS_ENABLED && frontierSpace.seen(index)) {
+            ++searchResult.stats.reopenings;
+        }
+    }
+
+    int pop(Frontier& frontier) {
+        int index;
+        if (fifo) {
+            index = frontier.cells[frontier.head++];
+        } else {
+            index = frontier.heap.pop();
+        }
+        return index;
+    }
+
+    // No cell left on a bidirectional frontier has a smaller key than this.
+    // Stale heap entries only make the bound lower, never wrong.
+    int lowerBound(const Frontier& frontier, const SearchSpace& frontierSpace) const {
+        if (fifo) {
+            return frontierSpace.g(frontier.cells[frontier.head]);
+        }
+        return static_cast<int>(frontier.heap.topKey() >> 32);
+    }
+
+    static Algorithm effectiveAlgorithm(const Grid& grid, Algorithm algorithm, const JumpTable* jumpTable,
+                                        const SearchSpace* reverseSpace, const HierarchicalMap* hierarchy,
+                                        const Movement& movement) {
+        if ((algorithm == Algorithm::JumpPoint || algorithm == Algorithm::JumpPointPlus) && !grid.uniformCost()) {
+            return Algorithm::AStar;
+        }
+        if ((algorithm == Algorithm::JumpPoint || algorithm == Algorithm::JumpPointPlus ||
+             algorithm == Algorithm::Hierarchical) &&
+            movement.connectivity == Connectivity::Eight) {
+            return Algorithm::AStar;
+        }
+        if ((algorithm == Algorithm::ThetaStar || algorithm == Algorithm::LazyThetaStar) && !grid.uniformCost()) {
+            return Algorithm::AStar;
+        }
+        if (algorithm == Algorithm::JumpPointPlus && (!jumpTable || !jumpTable->current(grid))) {
+            return Algorithm::JumpPoint;
+        }
+        if (algorithm == Algorithm::BidirectionalDijkstra && !reverseSpace) {
+            return Algorithm::Dijkstra;
+        }
+        if (algorithm == Algorithm::BidirectionalAStar && !reverseSpace) {
+            return Algorithm::AStar;
+        }
+        if (algorithm == Algorithm::Hierarchical && (!hierarchy || !hierarchy->current(grid))) {
+            return Algorithm::AStar;
+        }
+        return algorithm;
+    }
+
+    // Fills in what the algorithm implies: any-angle searches move eight
+    // ways (and A* standing in for one keeps doing so), D* Lite four ways,
+    // and Automatic picks the heuristic that fits the movement. Landmarks
+    // serve four-connected kernel searches that estimate towards the goal.
+    static Movement effectiveMovement(Algorithm algorithm, Movement movement, bool landmarksCurrent) {
+        if (algorithm == Algorithm::ThetaStar || algorithm == Algorithm::LazyThetaStar) {
+            movement.connectivity = Connectivity::Eight;
+        }
+        if (algorithm == Algorithm::DStarLite) {
+            movement.connectivity = Connectivity::Four;
+        }
+        if (movement.connectivity == Connectivity::Four) {
+            bool landmarks = landmarksCurrent &&
+                             (algorithm == Algorithm::AStar || algorithm == Algorithm::GreedyBestFirst) &&
+                             (movement.heuristic == Heuristic::Automatic || movement.heuristic == Heuristic::Landmarks);
+            movement.heuristic = landmarks ? Heuristic::Landmarks : Heuristic::Manhattan;
+        } else if (movement.heuristic == Heuristic::Automatic || movement.heuristic == Heuristic::Landmarks) {
+            bool anyAngle = algorithm == Algorithm::ThetaStar || algorithm == Algorithm::LazyThetaStar;
+            movement.heuristic = anyAngle ? Heuristic::Euclidean : Heuristic::Octile;
+        }
+        return movement;
+    }
+
+    bool anyAngle() const {
+        return algorithm == Algorithm::ThetaStar || algorithm == Algorithm::LazyThetaStar;
+    }
+
+    // Estimated distance between two cells, in distance units
+    int heuristic(const Cell& from, const Cell& to) const {
+        switch (movement.heuristic) {
+            case Heuristic::Octile: return detail::octile(from, to);
+            case Heuristic::Euclidean: return detail::euclidean(from, to);
+            case Heuristic::Landmarks:
+                if (to == goal) {
+                    return estimateToGoal<Heuristic::Landmarks, Connectivity::Four>(from, grid.index(from));
+                }
+                return detail::manhattan(from, to);
+            default: return detail::manhattan(from, to) * unit;
+        }
+    }
+
+    // The kernel's estimate from a cell to the goal. The landmark bound and
+    // Manhattan distance are both consistent, and so is their maximum.
+    template <Heuristic kernelHeuristic, Connectivity connectivity>
+    int estimateToGoal(const Cell& cell, int index) const {
+        if (kernelHeuristic == Heuristic::Landmarks) {
+            return std::max(detail::manhattan(cell, goal), landmarks->lowerBound(index, landmarkGoal));
+        }
+        return detail::estimate<kernelHeuristic, connectivity>(cell, goal);
+    }
+
+    // Calls visit(next, neighbor, length) for every cell a path may step to
+    // from the given one, walls included; length is the step's length in
+    // distance units
+    template <typename Visit>
+    void forEachMove(const Cell& cell, Visit visit) const {
+        for (const Cell& delta : detail::DELTAS) {
+            Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            if (grid.contains(neighbor)) {
+                visit(grid.index(neighbor), neighbor, unit);
+            }
+        }
+        if (movement.connectivity == Connectivity::Eight) {
+            for (const Cell& delta : detail::DIAGONAL_DELTAS) {
+                Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+                if (grid.contains(neighbor) && detail::diagonalAllowed(grid, cell, delta, movement.corners)) {
+                    visit(grid.index(neighbor), neighbor, DIAGONAL_STEP);
+                }
+            }
+        }
+    }
+
+    // Bidirectional A* orders both sides by the average of the two
+    // heuristics, p(v) = (h_goal(v) - h_start(v)) / 2 forward and -p(v)
+    // backward. That keeps both orderings consistent with one another, so the
+    // Dijkstra stopping rule below holds for A* too. Keys are doubled to stay
+    // integral and offset by the start-goal distance to stay non-negative.
+    int bidirectionalKey(const Cell& cell, int g, bool fromGoal) const {
+        if (algorithm == Algorithm::BidirectionalDijkstra) {
+            return g;
+        }
+        int toGoal = heuristic(cell, goal);
+        int toStart = heuristic(cell, start);
+        return 2 * g + (fromGoal ? toStart - toGoal : toGoal - toStart) + heuristic(start, goal);
+    }
+
+    // Any path cheaper than the best meeting would have to leave both
+    // frontiers below their smallest keys, so the search may stop once those
+    // add up to the best meeting (in key units).
+    bool canStop() const {
+        if (bestCost == SearchSpace::UNREACHED) {
+            return false;
+        }
+        long long bounds = static_cast<long long>(lowerBound(forward, space)) + lowerBound(backward, *reverseSpace);
+        if (algorithm == Algorithm::BidirectionalDijkstra) {
+            return bounds >= bestCost;
+        }
+        return bounds - 2LL * heuristic(start, goal) >= 2LL * bestCost;
+    }
+
+    bool stepBidirectional() {
+        while (true) {
+            // An exhausted frontier has seen its whole component, so the best
+            // meeting (if any) is final
+            if (openEmpty(forward) || openEmpty(backward) || canStop()) {
+                if (bestCost != SearchSpace::UNREACHED) {
+                    buildPath(meetingIndex);
+                }
+                finished = true;
+                return false;
+            }
+
+            // Grow the smaller frontier, which keeps the two balanced even when
+            // one end sits in a cramped corner
+            bool fromGoal = openSize(backward) < openSize(forward);
+            SearchSpace& sideSpace = fromGoal ? *reverseSpace : space;
+            int current = pop(fromGoal ? backward : forward);
+            if (sideSpace.closed(current)) {
+                if (STATS_ENABLED) {
+                    ++searchResult.stats.stalePops;
+                }
+                continue;
+            }
+
+            ++searchResult.expansions;
+            sideSpace.close(current);
+            expandBidirectional(current, fromGoal);
+            return true;
+        }
+    }
+
+    bool stepIncremental() {
+        int current = planner->step();
+        if (current < 0) {
+            PhaseTimer timer;
+            timer.start();
+            searchResult.found = planner->extractPath(searchResult.path, searchResult.cost);
+            searchResult.distance = searchResult.cost;
+            timer.stop();
+            searchResult.stats = planner->stats();
+            searchResult.stats.pathMilliseconds = timer.milliseconds();
+            finished = true;
+            return false;
+        }
+        ++searchResult.expansions;
+        if (observer) {
+            observer->onVisitFromGoal(grid.cellAt(current));
+        }
+        return true;
+    }
+
+    void expandBidirectional(int current, bool fromGoal) {
+        SearchSpace& own = fromGoal ? *reverseSpace : space;
+        const SearchSpace& other = fromGoal ? space : *reverseSpace;
+
+        forEachMove(grid.cellAt(current), [&](int next, const Cell& neighbor, int length) {
+            if (!grid.passable(next) || own.closed(next)) {
+                return;
+            }
+
+            // Moving forward pays for the cell entered. The goal side walks
+            // the same moves backwards, so it pays for the cell it leaves.
+            int newDistance = own.g(current) + grid.cost(fromGoal ? current : next) * length;
+            if (newDistance >= own.g(next)) {
+                return;
+            }
+
+            countReopening(own, next);
+            own.open(next, newDistance, current);
+            if (observer) {
+                if (fromGoal) {
+                    observer->onVisitFromGoal(neighbor);
+                } else {
+                    observer->onVisit(neighbor);
+                }
+            }
+            if (other.seen(next) && newDistance + other.g(next) < bestCost) {
+                bestCost = newDistance + other.g(next);
+                meetingIndex = next;
+            }
+
+            push(fromGoal ? backward : forward, next,
+                 priorityKey(bidirectionalKey(neighbor, newDistance, fromGoal), newDistance));
+        });
+    }
+
+    // The algorithms without a kernel: jump points, the abstract graph and
+    // any-angle moves
+    void expand(int current) {
+        if (algorithm == Algorithm::JumpPoint || algorithm == Algorithm::JumpPointPlus) {
+            expandJumpPoint(current);
+        } else if (algorithm == Algorithm::Hierarchical) {
+            expandAbstract(current);
+        } else {
+            expandAnyAngle(current);
+        }
+    }
+
+    Kernel selectKernel() const {
+        bool weighted = !grid.uniformCost();
+        switch (algorithm) {
+            case Algorithm::Dijkstra: return kernelWith<Algorithm::Dijkstra, Heuristic::Manhattan>(weighted);
+            case Algorithm::DepthFirst: return kernelWith<Algorithm::DepthFirst, Heuristic::Manhattan>(weighted);
+            case Algorithm::GreedyBestFirst: return kernelFor<Algorithm::GreedyBestFirst>(weighted);
+            case Algorithm::AStar: return kernelFor<Algorithm::AStar>(weighted);
+            default: return nullptr;
+        }
+    }
+
+    // Four-connected movement estimates with Manhattan distance or landmarks
+    // (see effectiveMovement); eight-connected kernels vary the heuristic
+    template <Algorithm kernelAlgorithm>
+    Kernel kernelFor(bool weighted) const {
+        if (movement.heuristic == Heuristic::Landmarks) {
+            return kernelWith<kernelAlgorithm, Heuristic::Landmarks>(weighted);
+        }
+        if (movement.connectivity == Connectivity::Eight && movement.heuristic == Heuristic::Octile) {
+            return kernelWith<kernelAlgorithm, Heuristic::Octile>(weighted);
+        }
+        if (movement.connectivity == Connectivity::Eight && movement.heuristic == Heuristic::Euclidean) {
+            return kernelWith<kernelAlgorithm, Heuristic::Euclidean>(weighted);
+        }
+        return kernelWith<kernelAlgorithm, Heuristic::Manhattan>(weighted);
+    }
+
+    template <Algorithm kernelAlgorithm, Heuristic kernelHeuristic>
+    Kernel kernelWith(bool weighted) const {
+        constexpr Heuristic fourWays =
+            kernelHeuristic == Heuristic::Landmarks ? Heuristic::Landmarks : Heuristic::Manhattan;
+        constexpr Heuristic eightWays = kernelHeuristic == Heuristic::Landmarks ? Heuristic::Octile : kernelHeuristic;
+        if (movement.connectivity == Connectivity::Four) {
+            return weighted ? &Search::stepKernel<kernelAlgorithm, Connectivity::Four, true, fourWays>
+                            : &Search::stepKernel<kernelAlgorithm, Connectivity::Four, false, fourWays>;
+        }
+        return weighted ? &Search::stepKernel<kernelAlgorithm, Connectivity::Eight, true, eightWays>
+                        : &Search::stepKernel<kernelAlgorithm, Connectivity::Eight, false, eightWays>;
+    }
+
+    // Uniform side steps let Dijkstra expand in FIFO order; weighted maps
+    // and diagonal steps need a heap
+    static constexpr OpenOrder openOrder(Algorithm kernelAlgorithm, Connectivity connectivity, bool weighted) {
+        return kernelAlgorithm == Algorithm::DepthFirst ? OpenOrder::Stack
+               : kernelAlgorithm == Algorithm::Dijkstra && connectivity == Connectivity::Four && !weighted
+                   ? OpenOrder::Queue
+                   : OpenOrder::Heap;
+    }
+
+    template <OpenOrder order>
+    void pushOpen(int index, std::uint64_t key) {
+        if (order == OpenOrder::Heap) {
+            forward.heap.push(key, index);
+        } else {
+            forward.cells.push_back(index);
+        }
+        if (STATS_ENABLED) {
+            SearchStats& stats = searchResult.stats;
+            ++stats.pushes;
+            size_t openEntries = order == OpenOrder::Heap ? forward.heap.size() : forward.cells.size() - forward.head;
+            stats.maxOpenSize = std::max(stats.maxOpenSize, static_cast<int>(openEntries));
+        }
+    }
+
+    // Pops the next cell, or returns -1 once the open list is empty
+    template <OpenOrder order>
+    int popOpen() {
+        if (order == OpenOrder::Heap) {
+            return forward.heap.empty() ? -1 : forward.heap.pop();
+        }
+        if (order == OpenOrder::Queue) {
+            return forward.head == forward.cells.size() ? -1 : forward.cells[forward.head++];
+        }
+        if (forward.cells.empty()) {
+            return -1;
+        }
+        int index = forward.cells.back();
+        forward.cells.pop_back();
+        return index;
+    }
+
+    // step() for a one-sided search over plain cell moves
+    template <Algorithm kernelAlgorithm, Connectivity connectivity, bool weighted, Heuristic kernelHeuristic>
+    bool stepKernel() {
+        constexpr OpenOrder order = openOrder(kernelAlgorithm, connectivity, weighted);
+        int current;
+        while (true) {
+            current = popOpen<order>();
+            if (current < 0) {
+                finished = true;
+                return false;
+            }
+            // A cell may have been pushed more than once; only the first
+            // (cheapest) entry popped is expanded
+            if (!space.closed(current)) {
+                break;
+            }
+            if (STATS_ENABLED) {
+                ++searchResult.stats.stalePops;
+            }
+        }
+
+        ++searchResult.expansions;
+        space.close(current);
+        if (current == goalIndex) {
+            buildPath(goalIndex);
+            finished = true;
+            return false;
+        }
+
+        Cell cell = grid.cellAt(current);
+        int distance = space.g(current);
+        for (int move = 0; move < detail::moveCount<connectivity>(); ++move) {
+            const Cell& delta = detail::MOVES[move];
+            Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            bool diagonal = move >= 4;
+            if (!grid.contains(neighbor) ||
+                (diagonal && !detail::diagonalAllowed(grid, cell, delta, movement.corners))) {
+                continue;
+            }
+            int next = current + delta.row * grid.cols() + delta.col;
+            if (!grid.passable(next) || space.closed(next)) {
+                continue;
+            }
+
+            int length = diagonal ? DIAGONAL_STEP : detail::sideStep<connectivity>();
+            int newDistance = distance + (weighted ? grid.cost(next) * length : length);
+            // DFS and greedy best-first take the most recent way to a cell:
+            // its push is the one popped first, so its parent wins
+            if ((kernelAlgorithm == Algorithm::Dijkstra || kernelAlgorithm == Algorithm::AStar) &&
+                newDistance >= space.g(next)) {
+                continue;
+            }
+
+            countReopening(space, next);
+            space.open(next, newDistance, current);
+            if (observer) {
+                observer->onVisit(neighbor);
+            }
+            // Every step costs at least its length, so Manhattan distance (four
+            // ways) and octile or Euclidean distance (eight ways) never
+            // overestimate; they are also consistent, as are landmark bounds,
+            // so A* never has to reopen a closed cell
+            switch (kernelAlgorithm) {
+                case Algorithm::Dijkstra: pushOpen<order>(next, priorityKey(newDistance)); break;
+                case Algorithm::GreedyBestFirst:
+                    pushOpen<order>(next, priorityKey(estimateToGoal<kernelHeuristic, connectivity>(neighbor, next)));
+                    break;
+                case Algorithm::AStar: {
+                    int estimate = estimateToGoal<kernelHeuristic, connectivity>(neighbor, next);
+                    pushOpen<order>(next, priorityKey(newDistance + estimate, newDistance));
+                    break;
+                }
+                default: pushOpen<order>(next, 0); break;
+            }
+        }
+        return true;
+    }
+
+    // Theta* offers each neighbor the current cell's parent as its own when
+    // the parent can see it, which pulls the path straight as it grows. Lazy
+    // Theta* assumes the parent can and checks only when the neighbor is
+    // expanded, which saves the line-of-sight checks for cells never expanded.
+    void expandAnyAngle(int current) {
+        Cell cell = grid.cellAt(current);
+        int parent = space.parent(current);
+        Cell anchor = parent == -1 ? cell : grid.cellAt(parent);
+        forEachMove(cell, [&](int next, const Cell& neighbor, int length) {
+            if (!grid.passable(next) || space.closed(next)) {
+                return;
+            }
+            int newDistance = space.g(current) + length;
+            int newParent = current;
+            if (parent != -1 && (algorithm == Algorithm::LazyThetaStar ||
+                                 detail::lineOfSight(grid, anchor, neighbor, movement.corners))) {
+                newDistance = space.g(parent) + detail::segmentLength(anchor, neighbor);
+                newParent = parent;
+            }
+            if (newDistance >= space.g(next)) {
+                return;
+            }
+            countReopening(space, next);
+            space.open(next, newDistance, newParent);
+            if (observer) {
+                observer->onVisit(neighbor);
+            }
+            push(forward, next, priorityKey(newDistance + heuristic(neighbor, goal), newDistance));
+        });
+    }
+
+    // Lazy Theta*: a cell whose assumed parent turns out to be hidden
+    // behind a wall takes the expanded neighbor it is cheapest to come from
+    // instead. The cell it was reached from is one, so there always is one.
+    void settleParent(int current) {
+        int parent = space.parent(current);
+        Cell cell = grid.cellAt(current);
+        if (parent == -1 || detail::lineOfSight(grid, grid.cellAt(parent), cell, movement.corners)) {
+            return;
+        }
+        int best = SearchSpace::UNREACHED;
+        int bestParent = -1;
+        forEachMove(cell, [&](int next, const Cell&, int length) {
+            if (space.closed(next) && space.g(next) + length < best) {
+                best = space.g(next) + length;
+                bestParent = next;
+            }
+        });
+        space.open(current, best, bestParent);
+    }
+
+    // Successors of a jump point are found by scanning straight runs in the
+    // directions the canonical ordering allows after arriving from its parent
+    void expandJumpPoint(int current) {
+        Cell cell = grid.cellAt(current);
+        int directions[4];
+        int directionCount = 0;
+        int parent = space.parent(current);
+        if (parent == -1) {
+            // The start may leave in every direction
+            directionCount = 4;
+            for (int i = 0; i < 4; ++i) {
+                directions[i] = i;
+            }
+        } else if (grid.cellAt(parent).row == cell.row) {
+            // After a horizontal move: keep going, or turn up or down
+            directions[directionCount++] = grid.cellAt(parent).col < cell.col ? detail::RIGHT : detail::LEFT;
+            directions[directionCount++] = detail::UP;
+            directions[directionCount++] = detail::DOWN;
+        } else {
+            // After a vertical move: keep going, or turn where a wall forces it
+            int dr = grid.cellAt(parent).row < cell.row ? 1 : -1;
+            directions[directionCount++] = dr > 0 ? detail::DOWN : detail::UP;
+            if (detail::walkable(grid, cell.row, cell.col - 1) && !detail::walkable(grid, cell.row - dr, cell.col - 1)) {
+                directions[directionCount++] = detail::LEFT;
+            }
+            if (detail::walkable(grid, cell.row, cell.col + 1) && !detail::walkable(grid, cell.row - dr, cell.col + 1)) {
+                directions[directionCount++] = detail::RIGHT;
+            }
+        }
+
+        for (int i = 0; i < directionCount; ++i) {
+            Cell jumpPoint;
+            bool found;
+            if (algorithm == Algorithm::JumpPointPlus) {
+                found = jumpTable->jump(grid, cell, directions[i], goal, jumpPoint);
+            } else if (jumpScanner) {
+                found = jumpScanner->jump(cell, directions[i], goal, jumpPoint);
+            } else {
+                found = detail::jump(grid, cell, directions[i], goal, jumpPoint);
+            }
+            if (!found) {
+                continue;
+            }
+            int next = grid.index(jumpPoint);
+            int newDistance = space.g(current) + detail::manhattan(cell, jumpPoint);
+            if (space.closed(next) || newDistance >= space.g(next)) {
+                continue;
+            }
+            countReopening(space, next);
+            space.open(next, newDistance, current);
+            if (observer) {
+                observer->onVisit(jumpPoint);
+            }
+            push(forward, next, priorityKey(newDistance + detail::manhattan(jumpPoint, goal), newDistance));
+        }
+    }
+
+    void connectEndpoints() {
+        hierarchy->connect(grid, startIndex, false, startLinks, scratch.cluster);
+        hierarchy->connect(grid, goalIndex, true, goalLinks, scratch.cluster);
+        goalCluster = hierarchy->clusterOf(goal);
+        // Endpoints sharing a cluster may also be joined directly
+        if (hierarchy->clusterOf(start) == goalCluster && startIndex != goalIndex) {
+            int distance = hierarchy->distanceWithinCluster(grid, startIndex, goalIndex, scratch.cluster);
+            if (distance != SearchSpace::UNREACHED) {
+                startLinks.push_back(AbstractEdge{goalIndex, distance});
+            }
+        }
+    }
+
+    void expandAbstract(int current) {
+        for (const AbstractEdge& edge : hierarchy->edges(current)) {
+            relaxAbstract(current, edge);
+        }
+        if (current == startIndex) {
+            for (const AbstractEdge& link : startLinks) {
+                relaxAbstract(current, link);
+            }
+        }
+        if (hierarchy->clusterOf(grid.cellAt(current)) == goalCluster) {
+            for (const AbstractEdge& link : goalLinks) {
+                if (link.cell == current) {
+                    relaxAbstract(current, AbstractEdge{goalIndex, link.cost});
+                }
+            }
+        }
+    }
+
+    void relaxAbstract(int current, const AbstractEdge& edge) {
+        int newDistance = space.g(current) + edge.cost;
+        if (space.closed(edge.cell) || newDistance >= space.g(edge.cell)) {
+            return;
+        }
+        countReopening(space, edge.cell);
+        space.open(edge.cell, newDistance, current);
+        Cell cell = grid.cellAt(edge.cell);
+        if (observer) {
+            observer->onVisit(cell);
+        }
+        // An abstract edge costs at least as much as its grid distance, so
+        // Manhattan distance stays admissible
+        push(forward, edge.cell, priorityKey(newDistance + detail::manhattan(cell, goal), newDistance));
+    }
+
+    // Builds the path through the given cell: the start side's parents lead
+    // back to the start and, after a bidirectional search, the goal side's
+    // parents lead on to the goal
+    void buildPath(int through) {
+        // Trace back the path from the goal to the start. Consecutive cells
+        // are neighbors except after JPS, whose parents are whole straight runs
+        // away; those runs are filled in cell by cell. Any-angle paths keep
+        // only their turning points.
+        PhaseTimer timer;
+        timer.start();
+        int current = through;
+        if (algorithm == Algorithm::Hierarchical) {
+            // HPA* parents are abstract nodes; each edge is refined into cells
+            // by a search within its cluster
+            std::vector<int>& waypoints = scratch.waypoints;
+            waypoints.clear();
+            for (; current != -1; current = space.parent(current)) {
+                waypoints.push_back(current);
+            }
+            std::reverse(waypoints.begin(), waypoints.end());
+            searchResult.path.push_back(grid.cellAt(startIndex));
+            hierarchy->refine(grid, waypoints, searchResult.path, scratch.cluster);
+            current = startIndex;
+        }
+        while (current != startIndex) {
+            Cell cell = grid.cellAt(current);
+            Cell parent = grid.cellAt(space.parent(current));
+            int steps = anyAngle() ? 1 : std::max(std::abs(cell.row - parent.row), std::abs(cell.col - parent.col));
+            for (int i = 0; i < steps; ++i) {
+                searchResult.path.push_back(Cell{cell.row + (parent.row - cell.row) * i / steps,
+                                                 cell.col + (parent.col - cell.col) * i / steps});
+            }
+            current = space.parent(current);
+        }
+        if (algorithm != Algorithm::Hierarchical) {
+            searchResult.path.push_back(grid.cellAt(startIndex));
+            std::reverse(searchResult.path.begin(), searchResult.path.end());
+        }
+        if (bidirectional) {
+            for (int next = reverseSpace->parent(through); next != -1; next = reverseSpace->parent(next)) {
+                searchResult.path.push_back(grid.cellAt(next));
+            }
+        }
+        searchResult.found = true;
+        searchResult.distance = 0.0;
+        for (size_t i = 1; i < searchResult.path.size(); ++i) {
+            const Cell& from = searchResult.path[i - 1];
+            const Cell& to = searchResult.path[i];
+            double length = from.row == to.row || from.col == to.col
+                                ? std::abs(to.row - from.row) + std::abs(to.col - from.col)
+                                : std::hypot(to.row - from.row, to.col - from.col);
+            searchResult.distance += grid.cost(grid.index(to)) * length;
+        }
+        searchResult.cost = static_cast<int>(std::lround(searchResult.distance));
+        timer.stop();
+        searchResult.stats.pathMilliseconds = timer.milliseconds();
+    }
+};
+
+// Runs queries against one grid, reusing the per-cell search state between
+// them. Keep one PathFinder per thread when issuing many queries. The JPS+
+// jump table is built on the first JPS+ query and rebuilt after grid edits,
+// and so are the bitboards plain JPS scans with;
+// the HPA* graph is built on the first HPA* query and afterwards updates
+// only the clusters edits touched. The goal-side buffers are allocated by
+// the first bidirectional query. The component labels that reject
+// unreachable goals are built by the first query and updated from the
+// grid's edit journal before later ones.
+//
+// Open lists, paths and the D* Lite planner live in one SearchScratch that
+// every query reuses. Once a few queries have grown it, a query begun on an
+// unchanged grid allocates nothing: tools/bench.cpp -c checks this with a
+// counting allocator. A PathCache (path_cache.hpp) can answer repeated
+// queries in front of it.
+class PathFinder {
+public:
+    explicit PathFinder(const Grid& grid) : grid(grid), space(grid.cellCount()) {}
+
+    // Applies to the queries begun from now on
+    void setMovement(const Movement& newMovement) { movement = newMovement; }
+
+    // Landmarks for A* and greedy best-first, used while they are current for
+    // the grid; the table must outlive the queries. Building one takes a full
+    // search per landmark, so unlike the other tables it is never built here.
+    void setLandmarks(const LandmarkTable* table) { landmarks = table; }
+
+    // Starts a query to be driven step by step. Starting another query from
+    // the same PathFinder invalidates the previous one.
+    Search begin(Algorithm algorithm, const Cell& start, const Cell& goal, SearchObserver* observer = nullptr) {
+        bool fourWay = movement.connectivity == Connectivity::Four;
+        if (algorithm == Algorithm::JumpPointPlus && grid.uniformCost() && fourWay &&
+            (!jumpTable || !jumpTable->current(grid))) {
+            jumpTable.reset(new JumpTable(grid));
+        }
+        if (algorithm == Algorithm::JumpPoint && grid.uniformCost() && fourWay &&
+            (!jumpScanner || !jumpScanner->current(grid))) {
+            jumpScanner.reset(new JumpScanner(grid));
+        }
+        if (algorithm == Algorithm::Hierarchical && fourWay) {
+            if (!hierarchy) {
+                hierarchy.reset(new HierarchicalMap(grid));
+            } else if (!hierarchy->current(grid)) {
+                hierarchy->update(grid);
+            }
+        }
+        // Labeling costs a pass over the whole grid, more than a single
+        // query on a big map, so the labels wait for the second query
+        if (components && !components->current(grid)) {
+            components->update(grid);
+        } else if (!components && queryCount > 0) {
+            components.reset(new ComponentMap(grid));
+        }
+        ++queryCount;
+        SearchTables tables;
+        tables.jumpTable = jumpTable.get();
+        tables.jumpScanner = jumpScanner.get();
+        tables.hierarchy = hierarchy.get();
+        tables.components = components.get();
+        tables.landmarks = landmarks;
+        return Search(grid, space, algorithm, start, goal, observer, tables, movement, &reverseSpace, &scratch);
+    }
+
+    // Returns a copy of the result, path included
+    SearchResult findPath(Algorithm algorithm, const Cell& start, const Cell& goal,
+                          SearchObserver* observer = nullptr) {
+        return begin(algorithm, start, goal, observer).run();
+    }
+
+private:
+    friend class PathCache;
+
+    const Grid& grid;
+    SearchSpace space;
+    SearchSpace reverseSpace;
+    std::unique_ptr<JumpTable> jumpTable;
+    std::unique_ptr<JumpScanner> jumpScanner;
+    std::unique_ptr<HierarchicalMap> hierarchy;
+    std::unique_ptr<ComponentMap> components;
+    SearchScratch scratch;
+    Movement movement;
+    const LandmarkTable* landmarks = nullptr;
+    int queryCount = 0;
+};
+
+// Runs one query with freshly allocated search state and no component
+// labels, so an unreachable goal floods the start's region. Callers with more
+// than one query should keep a PathFinder.
+inline SearchResult findPath(const Grid& grid, Algorithm algorithm, const Cell& start, const Cell& goal,
+                             SearchObserver* observer = nullptr) {
+    return PathFinder(grid).findPath(algorithm, start, goal, observer);
+}
+
+} // namespace pathfinder
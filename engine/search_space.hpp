@@ -0,0 +1,73 @@
+#pragma once
+
+// Per-query search state (g-score, parent, open/closed) kept in flat
+// structure-of-arrays buffers that are allocated once per grid size and
+// reused. Starting a new query bumps a generation counter instead of
+// clearing the buffers, so reset is O(1) no matter how big the map is.
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace pathfinder {
+
+class SearchSpace {
+public:
+    static constexpr int UNREACHED = std::numeric_limits<int>::max();
+
+    SearchSpace() = default;
+    explicit SearchSpace(int cellCount) { resize(cellCount); }
+
+    void resize(int cellCount) {
+        if (static_cast<size_t>(cellCount) != stamp.size()) {
+            gScore.assign(cellCount, UNREACHED);
+            parentIndex.assign(cellCount, -1);
+            stamp.assign(cellCount, 0);
+            generation = 2;
+        }
+    }
+
+    int size() const { return static_cast<int>(stamp.size()); }
+
+    size_t memoryUsage() const {
+        return gScore.capacity() * sizeof(int) + parentIndex.capacity() * sizeof(int) +
+               stamp.capacity() * sizeof(std::uint32_t);
+    }
+
+    // Forget every cell touched by the previous query
+    void reset() {
+        generation += 2;
+        if (generation < 2) {
+            // The counter wrapped around, old stamps could look current again
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 2;
+        }
+    }
+
+    // A cell is "seen" once it has a g-score in the current query, and
+    // "closed" once it has been expanded
+    bool seen(int index) const { return stamp[index] >= generation; }
+    bool closed(int index) const { return stamp[index] == generation + 1; }
+
+    int g(int index) const { return seen(index) ? gScore[index] : UNREACHED; }
+    int parent(int index) const { return seen(index) ? parentIndex[index] : -1; }
+
+    void open(int index, int g, int parent) {
+        gScore[index] = g;
+        parentIndex[index] = parent;
+        if (stamp[index] < generation) {
+            stamp[index] = generation;
+        }
+    }
+
+    void close(int index) { stamp[index] = generation + 1; }
+
+private:
+    std::vector<int> gScore;
+    std::vector<int> parentIndex;
+    std::vector<std::uint32_t> stamp;
+    std::uint32_t generation = 2;
+};
+
+} // namespace pathfinder
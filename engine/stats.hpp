@@ -0,0 +1,51 @@
+#pragma once
+
+// Instrumentation for the searches: counters kept per query and a timer for
+// phases the caller wants to measure. Build with -DPATHFINDER_STATS=0 to
+// compile it all out; every update is guarded by the STATS_ENABLED constant,
+// so the optimizer drops the counters from the hot loops.
+
+#include <chrono>
+
+#ifndef PATHFINDER_STATS
+#define PATHFINDER_STATS 1
+#endif
+
+namespace pathfinder {
+
+constexpr bool STATS_ENABLED = PATHFINDER_STATS != 0;
+
+struct SearchStats {
+    int pushes = 0;      // Open list insertions
+    int stalePops = 0;   // Popped entries skipped because their cell was already expanded
+    int reopenings = 0;  // Cheaper distances found for cells already on the open list
+    int maxOpenSize = 0; // Largest open list, stale entries included
+    double pathMilliseconds = 0.0; // Tracing the path back once the goal was reached
+};
+
+// Adds up wall time over any number of start()/stop() intervals
+class PhaseTimer {
+public:
+    void start() {
+        if (STATS_ENABLED) {
+            begin = Clock::now();
+        }
+    }
+
+    void stop() {
+        if (STATS_ENABLED) {
+            total += Clock::now() - begin;
+        }
+    }
+
+    void reset() { total = Clock::duration::zero(); }
+
+    double milliseconds() const { return std::chrono::duration<double, std::milli>(total).count(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point begin;
+    Clock::duration total = Clock::duration::zero();
+};
+
+} // namespace pathfinder
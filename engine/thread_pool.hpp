@@ -0,0 +1,172 @@
+#pragma once
+
+// A fixed set of worker threads for data-parallel loops. parallelFor() cuts
+// a range into chunks and deals each thread a run of them. A thread takes
+// chunks from the front of its own run and, once that is empty, steals from
+// the back of another's, so a loop whose work is lopsided (a search frontier
+// crowded into one corner of the map) still keeps every thread busy. The
+// calling thread works as thread 0; the others sleep between loops.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pathfinder {
+
+class ThreadPool {
+public:
+    // threadCount 0 uses one thread per hardware thread
+    explicit ThreadPool(int threadCount = 0) {
+        if (threadCount <= 0) {
+            threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        runs.reset(new ChunkRun[threadCount]);
+        this->threadCount = threadCount;
+        for (int thread = 1; thread < threadCount; ++thread) {
+            threads.emplace_back(&ThreadPool::work, this, thread);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return threadCount; }
+
+    // Calls body(begin, end, thread) for consecutive pieces of [0, count) of
+    // at most grain items each, where thread (0 to size() - 1) identifies the
+    // thread running the piece, and returns once all have run. The body must
+    // not throw, and must not start another loop on the same pool.
+    template <typename Body>
+    void parallelFor(int count, int grain, Body body) {
+        if (count <= 0) {
+            return;
+        }
+        grain = std::max(1, grain);
+        int chunks = (count + grain - 1) / grain;
+        if (threadCount == 1 || chunks == 1) {
+            for (int begin = 0; begin < count; begin += grain) {
+                body(begin, std::min(count, begin + grain), 0);
+            }
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // A thread that woke too late for the previous loop may still be
+            // looking for its chunks
+            finished.wait(lock, [&] { return busy == 0; });
+            for (int thread = 0; thread < threadCount; ++thread) {
+                std::lock_guard<std::mutex> runLock(runs[thread].lock);
+                runs[thread].next = static_cast<int>(static_cast<long long>(chunks) * thread / threadCount);
+                runs[thread].end = static_cast<int>(static_cast<long long>(chunks) * (thread + 1) / threadCount);
+            }
+            job = Job{&ThreadPool::invoke<Body>, &body, count, grain};
+            pending.store(chunks, std::memory_order_relaxed);
+            ++generation;
+        }
+        wake.notify_all();
+        runChunks(0, job);
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return pending.load(std::memory_order_acquire) == 0; });
+    }
+
+private:
+    struct Job {
+        void (*call)(void* body, int begin, int end, int thread);
+        void* body;
+        int count;
+        int grain;
+    };
+
+    // The chunks [next, end) not yet taken from one thread's share
+    struct alignas(64) ChunkRun {
+        std::mutex lock;
+        int next = 0;
+        int end = 0;
+    };
+
+    int threadCount = 1;
+    std::unique_ptr<ChunkRun[]> runs;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    Job job = {};
+    unsigned generation = 0;
+    int busy = 0; // Threads that joined the current loop and still look for chunks
+    bool stopping = false;
+    std::atomic<int> pending{0};
+
+    template <typename Body>
+    static void invoke(void* body, int begin, int end, int thread) {
+        (*static_cast<Body*>(body))(begin, end, thread);
+    }
+
+    void work(int thread) {
+        unsigned seen = 0;
+        while (true) {
+            Job current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                current = job;
+                ++busy;
+            }
+            runChunks(thread, current);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --busy;
+            }
+            finished.notify_all();
+        }
+    }
+
+    // Runs the thread's own chunks, then steals until there are none left
+    void runChunks(int thread, const Job& current) {
+        while (true) {
+            int chunk = takeOwn(thread);
+            for (int offset = 1; chunk < 0 && offset < threadCount; ++offset) {
+                chunk = steal((thread + offset) % threadCount);
+            }
+            if (chunk < 0) {
+                return;
+            }
+            int begin = chunk * current.grain;
+            current.call(current.body, begin, std::min(current.count, begin + current.grain), thread);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+
+    int takeOwn(int thread) {
+        std::lock_guard<std::mutex> lock(runs[thread].lock);
+        return runs[thread].next < runs[thread].end ? runs[thread].next++ : -1;
+    }
+
+    int steal(int victim) {
+        std::lock_guard<std::mutex> lock(runs[victim].lock);
+        return runs[victim].next < runs[victim].end ? --runs[victim].end : -1;
+    }
+};
+
+} // namespace pathfinder
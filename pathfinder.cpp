@@ -1,382 +1,659 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
-#include <queue>
-#include <stack>
-#include <limits>
-#include <chrono>
-#include <thread>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "engine/grid_file.hpp"
+#include "engine/landmarks.hpp"
+#include "engine/map_io.hpp"
+#include "engine/multi_agent.hpp"
+#include "engine/search.hpp"
 
-const int GRID_SIZE = 20;
 const int WINDOW_SIZE = 800;
-const int CELL_SIZE = WINDOW_SIZE / GRID_SIZE;
-const int DELAY_MS = 50; // Delay in milliseconds after each iteration
+const int DEFAULT_GRID_SIZE = 20;
+const float MIN_CELL_PIXELS = 2.0f; // Zoom-out limit, bounds how many cells are drawn per frame
+const float BORDER_MIN_PIXELS = 6.0f; // Cells smaller than this on screen are drawn without a border
+const int FRAME_RATE = 60;
+const int FRAME_BUDGET_MS = 10; // Search time allowed per frame, keeps input and redraw responsive
+const int INSTANT = -1;
+// Expansions per frame for each speed setting; 0 is paused (N steps once)
+const int SPEED_LEVELS[] = {0, 1, 2, 5, 10, 50, 200, 1000, 10000, INSTANT};
+const int SPEED_LEVEL_COUNT = sizeof(SPEED_LEVELS) / sizeof(SPEED_LEVELS[0]);
+const int DEFAULT_SPEED_LEVEL = 1;
+const int AGENT_SPEED_LEVEL = 3; // Multi-agent plans play at 5 steps per second to begin with
+const int MUD_COST = 5; // Traversal cost painted by the mud brush
+const char* const FONT_FILE = "fonts/times new roman.ttf";
+const unsigned STATS_TEXT_SIZE = 14;
+const unsigned NO_PATH_TEXT_SIZE = 28;
+const char* const SAVED_MAP_FILE = "map.grid"; // Where S saves a map that was not loaded from a file
+const float AGENT_RADIUS = 0.35f; // In cells
+
+// What the visualizer shows for a cell
+enum class CellState : std::uint8_t {
+    Empty,
+    Wall,
+    Mud,
+    Visited,
+    VisitedMud,
+    VisitedFromGoal,
+    VisitedFromGoalMud,
+    Path,
+    Start,
+    End
+};
 
-class PathfindingVisualizer {
-public:
-    PathfindingVisualizer() : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Pathfinding Visualizer") {
-        initializeGrid();
-        run();
+inline sf::Color cellColor(CellState state) {
+    switch (state) {
+        case CellState::Empty: return sf::Color(75,54,95);
+        case CellState::Wall: return sf::Color(20,20,28);
+        case CellState::Mud: return sf::Color(120,84,50);
+        case CellState::Visited: return sf::Color(223,215,200);
+        case CellState::VisitedMud: return sf::Color(190,160,120);
+        case CellState::VisitedFromGoal: return sf::Color(160,200,230);
+        case CellState::VisitedFromGoalMud: return sf::Color(130,150,170);
+        case CellState::Path: return sf::Color::Yellow;
+        case CellState::Start: return sf::Color(170,219,30);
+        case CellState::End: return sf::Color(244,54,76);
     }
+    return sf::Color::Black;
+}
 
-private:
-    sf::RenderWindow window;
-    std::vector<std::vector<sf::RectangleShape>> grid;
-    sf::Vector2i startCell;
-    sf::Vector2i endCell;
-    bool pathFound;
-    std::vector<std::vector<sf::Vector2i>> parent;
+// Agents take these colors in turn, for their discs, paths and goal markers
+const sf::Color AGENT_COLORS[] = {
+    sf::Color(230,25,75), sf::Color(60,180,75), sf::Color(255,225,25), sf::Color(0,130,200),
+    sf::Color(245,130,48), sf::Color(145,30,180), sf::Color(70,240,240), sf::Color(240,50,230),
+    sf::Color(210,245,60), sf::Color(250,190,212), sf::Color(0,128,128), sf::Color(220,190,255)
+};
+const int AGENT_COLOR_COUNT = sizeof(AGENT_COLORS) / sizeof(AGENT_COLORS[0]);
+
+// Draws the part of the grid that lies inside a view as one sf::VertexArray
+// of quads, so a frame costs a single draw call however many cells are on
+// screen. Cell states are written through setState(), which remembers the
+// cell as dirty; the next draw() only rewrites the vertices of those cells,
+// and rebuilds the whole array only when the visible region changes.
+class GridRenderer {
+public:
+    GridRenderer(int rows, int cols)
+        : rows(rows), cols(cols), states(static_cast<size_t>(rows) * cols, CellState::Empty),
+          vertices(sf::Quads), firstRow(0), firstCol(0), visibleRows(0), visibleCols(0), gap(-1.0f) {}
 
-    void initializeGrid() {
-        grid.resize(GRID_SIZE, std::vector<sf::RectangleShape>(GRID_SIZE));
+    CellState state(const pathfinder::Cell& cell) const {
+        return states[index(cell)];
+    }
 
-        // Initialize the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                grid[i][j].setSize(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-                grid[i][j].setPosition(j * CELL_SIZE, i * CELL_SIZE);
-                grid[i][j].setFillColor(sf::Color(75,54,95));
-                // Set border properties
-                grid[i][j].setOutlineThickness(1); // Border thickness
-                grid[i][j].setOutlineColor(sf::Color::Black); // Border color
-            }
+    void setState(const pathfinder::Cell& cell, CellState state) {
+        size_t i = index(cell);
+        if (states[i] != state) {
+            states[i] = state;
+            dirty.push_back(cell);
         }
     }
 
-    void findShortestPath() {
-        // Perform Dijkstra's algorithm
-        std::vector<std::vector<bool>> visited(GRID_SIZE, std::vector<bool>(GRID_SIZE, false));
-        parent.resize(GRID_SIZE, std::vector<sf::Vector2i>(GRID_SIZE));
-        std::vector<std::vector<int>> distance(GRID_SIZE, std::vector<int>(GRID_SIZE, std::numeric_limits<int>::max()));
-        std::queue<sf::Vector2i> q;
-        q.push(startCell);
-        distance[startCell.x][startCell.y] = 0;
-
-        while (!q.empty()) {
-            sf::Vector2i current = q.front();
-            q.pop();
-            visited[current.x][current.y] = true;
-
-            if (current == endCell) {
-                // Reached the end cell, stop the algorithm
-                break;
-            }
-
-            // Define the deltas for moving in four directions: up, down, left, and right
-            std::vector<sf::Vector2i> deltas = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
-
-            // Iterate over the horizontally and vertically neighboring cells
-            for (const auto& delta : deltas) {
-                sf::Vector2i neighbor(current.x + delta.x, current.y + delta.y);
-
-                // Check if the neighboring cell is within the grid bounds and not a wall
-                if (neighbor.x >= 0 && neighbor.x < GRID_SIZE && neighbor.y >= 0 && neighbor.y < GRID_SIZE &&
-                    !visited[neighbor.x][neighbor.y]) {
-                    int newDistance = distance[current.x][current.y] + 1;
-
-                    if (newDistance < distance[neighbor.x][neighbor.y]) {
-                        distance[neighbor.x][neighbor.y] = newDistance;
-                        parent[neighbor.x][neighbor.y] = current;
-                        grid[neighbor.x][neighbor.y].setFillColor(sf::Color(223,215,200)); // Color the visited node as black
-                        window.clear();
-                        drawGrid(); // Draw the updated grid
-                        window.display();
-                        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY_MS)); // Delay for visualization
-                        q.push(neighbor);
-                    }
+    void draw(sf::RenderTarget& target, const sf::View& view, float pixelsPerCell) {
+        sf::Vector2f center = view.getCenter();
+        sf::Vector2f size = view.getSize();
+        int top = std::max(0, static_cast<int>(std::floor(center.y - size.y / 2.0f)));
+        int left = std::max(0, static_cast<int>(std::floor(center.x - size.x / 2.0f)));
+        int bottom = std::min(rows - 1, static_cast<int>(std::ceil(center.y + size.y / 2.0f)));
+        int right = std::min(cols - 1, static_cast<int>(std::ceil(center.x + size.x / 2.0f)));
+
+        // The black background shows through a one pixel gap as the cell border
+        float newGap = pixelsPerCell >= BORDER_MIN_PIXELS ? 1.0f / pixelsPerCell : 0.0f;
+
+        if (top != firstRow || left != firstCol || bottom - top + 1 != visibleRows ||
+            right - left + 1 != visibleCols || newGap != gap) {
+            rebuild(top, left, std::max(0, bottom - top + 1), std::max(0, right - left + 1), newGap);
+        } else {
+            for (const pathfinder::Cell& cell : dirty) {
+                if (visible(cell)) {
+                    writeQuad(cell);
                 }
             }
         }
-        pathFound=true;
-    }
+        dirty.clear();
 
-    void findAndColorShortestPath() {
-        // Trace back the path from the end cell to the start cell
-        sf::Vector2i current = endCell;
-        while (current != startCell) {
-            grid[current.x][current.y].setFillColor(sf::Color::Yellow);
-            current = parent[current.x][current.y];
-        }
+        target.setView(view);
+        target.draw(vertices);
+        target.setView(target.getDefaultView());
     }
 
-    void drawGrid() {
-        // Draw the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                window.draw(grid[i][j]);
-            }
-        }
+private:
+    int rows;
+    int cols;
+    std::vector<CellState> states; // Flat row-major, like the engine's grid
+    std::vector<pathfinder::Cell> dirty;
+    sf::VertexArray vertices;
+    int firstRow;
+    int firstCol;
+    int visibleRows;
+    int visibleCols;
+    float gap;
+
+    size_t index(const pathfinder::Cell& cell) const {
+        return static_cast<size_t>(cell.row) * cols + cell.col;
     }
 
-    void run() {
-        while (window.isOpen()) {
-            sf::Event event;
-            while (window.pollEvent(event)) {
-                if (event.type == sf::Event::Closed) {
-                    window.close();
-                }
-
-                if (!pathFound && event.type == sf::Event::MouseButtonPressed) {
-                    handleMouseClick(event.mouseButton);
-                }
+    bool visible(const pathfinder::Cell& cell) const {
+        return cell.row >= firstRow && cell.row < firstRow + visibleRows &&
+               cell.col >= firstCol && cell.col < firstCol + visibleCols;
+    }
 
-                if (!pathFound && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
-                    findShortestPath();
-                    findAndColorShortestPath();
-                }
+    void rebuild(int top, int left, int height, int width, float newGap) {
+        firstRow = top;
+        firstCol = left;
+        visibleRows = height;
+        visibleCols = width;
+        gap = newGap;
+        vertices.resize(static_cast<size_t>(visibleRows) * visibleCols * 4);
+        for (int i = 0; i < visibleRows; ++i) {
+            for (int j = 0; j < visibleCols; ++j) {
+                writeQuad(pathfinder::Cell{firstRow + i, firstCol + j});
             }
-
-            window.clear();
-            drawGrid();
-            window.display();
         }
     }
-    void handleMouseClick(sf::Event::MouseButtonEvent mouseEvent) {
-        int row = mouseEvent.y / CELL_SIZE;
-        int col = mouseEvent.x / CELL_SIZE;
 
-        if (mouseEvent.button == sf::Mouse::Left) {
-            // Left mouse click sets the start cell
-            startCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(170,219,30));
-        } else if (mouseEvent.button == sf::Mouse::Right) {
-            // Right mouse click sets the end cell
-            endCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(244,54,76));
-        }
+    void writeQuad(const pathfinder::Cell& cell) {
+        size_t offset = (static_cast<size_t>(cell.row - firstRow) * visibleCols + (cell.col - firstCol)) * 4;
+        sf::Vertex* quad = &vertices[offset];
+        float x0 = cell.col + gap / 2.0f;
+        float y0 = cell.row + gap / 2.0f;
+        float x1 = cell.col + 1.0f - gap / 2.0f;
+        float y1 = cell.row + 1.0f - gap / 2.0f;
+        sf::Color color = cellColor(states[index(cell)]);
+        quad[0] = sf::Vertex(sf::Vector2f(x0, y0), color);
+        quad[1] = sf::Vertex(sf::Vector2f(x1, y0), color);
+        quad[2] = sf::Vertex(sf::Vector2f(x1, y1), color);
+        quad[3] = sf::Vertex(sf::Vector2f(x0, y1), color);
     }
 };
 
-class PathfindingVisualizer1 {
+// Draws a grid and lets the user pick start/end cells, then animates one of the
+// engine's searches. The search itself lives in engine/ and knows nothing about
+// SFML; this class only watches it through SearchObserver.
+//
+// The search is advanced a few expansions per frame from the event loop, so
+// the window keeps responding while it runs. +/- change the speed from paused
+// (N steps one expansion) to instant, Space pauses and resumes.
+//
+// The map can be any size. The window shows it through a view measured in
+// cells (one world unit per cell): the mouse wheel zooms, the middle button
+// or the arrow keys pan, and GridRenderer draws only the cells inside the view.
+//
+// Before a search the map can be edited with a brush: 1 places start/end
+// cells, 2 paints walls and 3 paints mud (cost MUD_COST). With the wall and
+// mud brushes the left button paints and the right button erases while
+// dragging; holding Shift when pressing fills a rectangle instead. D switches
+// between four- and eight-connected movement and C cycles the rule for
+// cutting corners on diagonal steps; Theta* and Lazy Theta* always move at
+// any angle and draw every cell their straight segments cross.
+//
+// Unless the engine is built with PATHFINDER_STATS=0, an overlay (I toggles
+// it) shows the search's counters and the time spent searching, tracing and
+// coloring the path, and drawing the last frame.
+//
+// In multi-agent mode (Cooperative A* or CBS, see engine/multi_agent.hpp)
+// the endpoint brush places agents instead: the left button places a new
+// agent's start and the right button its goal. Enter plans all of them at
+// once, and the agents then move along their paths over time, each in its
+// own color; the speed keys set the steps per second and Enter replays.
+enum class Brush {
+    Endpoints,
+    Wall,
+    Mud
+};
+
+class PathfindingVisualizer : public pathfinder::SearchObserver {
 public:
-    PathfindingVisualizer1() : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Pathfinding Visualizer") {
+    PathfindingVisualizer(pathfinder::Algorithm algorithm, const pathfinder::Grid& initialMap, const std::string& mapFile)
+        : PathfindingVisualizer(algorithm, false, pathfinder::MultiAgentSolver::ConflictBased, initialMap, mapFile) {}
+
+    // Plans several agents at once instead of animating a single search
+    PathfindingVisualizer(pathfinder::MultiAgentSolver solver, const pathfinder::Grid& initialMap,
+                          const std::string& mapFile)
+        : PathfindingVisualizer(pathfinder::Algorithm::AStar, true, solver, initialMap, mapFile) {}
+
+private:
+    PathfindingVisualizer(pathfinder::Algorithm algorithm, bool multiAgent, pathfinder::MultiAgentSolver solver,
+                          const pathfinder::Grid& initialMap, const std::string& mapFile)
+        : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE),
+                 std::string("Pathfinding Visualizer - ") +
+                     (multiAgent ? pathfinder::multiAgentSolverName(solver) : pathfinder::algorithmName(algorithm))),
+          algorithm(algorithm), map(initialMap), mapFile(mapFile), finder(map), renderer(map.rows(), map.cols()),
+          pathFound(false),
+          speedLevel(multiAgent ? AGENT_SPEED_LEVEL : DEFAULT_SPEED_LEVEL),
+          resumeSpeedLevel(multiAgent ? AGENT_SPEED_LEVEL : DEFAULT_SPEED_LEVEL), brush(Brush::Endpoints),
+          painting(false), erasing(false), fillingRectangle(false), panning(false), showStats(true),
+          replanPending(false), goalMoved(false), multiAgent(multiAgent), solver(solver), goalPending(false),
+          agentStep(0.0f) {
+        window.setFramerateLimit(FRAME_RATE);
+        fontLoaded = font.loadFromFile(FONT_FILE);
         initializeGrid();
+        loadLandmarks();
+        updateTitle();
         run();
     }
 
-private:
     sf::RenderWindow window;
-    std::vector<std::vector<sf::RectangleShape>> grid;
-    sf::Vector2i startCell;
-    sf::Vector2i endCell;
+    sf::View view;
+    pathfinder::Algorithm algorithm;
+    pathfinder::Grid map;
+    std::string mapFile; // Empty unless the map was loaded from disk
+    // Saved next to the map by tools/landmarks.cpp; A* and greedy best-first
+    // use them until the first edit
+    std::unique_ptr<pathfinder::LandmarkTable> landmarks;
+    pathfinder::PathFinder finder;
+    pathfinder::Movement movement;
+    GridRenderer renderer;
+    pathfinder::Cell startCell;
+    pathfinder::Cell endCell;
     bool pathFound;
-    std::vector<std::vector<sf::Vector2i>> parent;
+    std::unique_ptr<pathfinder::Search> search;
+    int speedLevel;
+    int resumeSpeedLevel;
+    Brush brush;
+    bool painting;
+    bool erasing;
+    bool fillingRectangle;
+    pathfinder::Cell strokeStart;
+    pathfinder::Cell lastPaintedCell;
+    bool panning;
+    sf::Vector2i lastMousePosition;
+    sf::Font font;
+    bool fontLoaded;
+    bool showStats;
+    pathfinder::PhaseTimer searchTimer;
+    pathfinder::PhaseTimer colorTimer;
+    pathfinder::PhaseTimer drawTimer;
+    // Cells the current search has colored, so a replan can clear them again
+    std::vector<pathfinder::Cell> searchedCells;
+    // D* Lite keeps planning after its first path: edits made since then
+    // are fed to the same search once the current stroke ends
+    bool replanPending;
+    bool goalMoved;
+    // Multi-agent mode: the agents placed so far, whether the last one still
+    // waits for its goal, and once planned the plan and where the animation is
+    bool multiAgent;
+    pathfinder::MultiAgentSolver solver;
+    std::vector<pathfinder::Agent> agents;
+    bool goalPending;
+    std::unique_ptr<pathfinder::MultiAgentPlan> plan;
+    pathfinder::ThreadPool pool;
+    float agentStep; // Steps since the agents set off, fractional between two steps
+    sf::Clock animationClock;
 
     void initializeGrid() {
-        grid.resize(GRID_SIZE, std::vector<sf::RectangleShape>(GRID_SIZE));
-
-        // Initialize the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                grid[i][j].setSize(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-                grid[i][j].setPosition(j * CELL_SIZE, i * CELL_SIZE);
-                grid[i][j].setFillColor(sf::Color(75,54,95));
-                grid[i][j].setOutlineThickness(1); // Border thickness
-                grid[i][j].setOutlineColor(sf::Color::Black); // Border color
+        // Fit the whole map into the window unless its cells would become too small
+        sf::Vector2u windowSize = window.getSize();
+        float cellPixels = std::min(static_cast<float>(windowSize.x) / map.cols(),
+                                    static_cast<float>(windowSize.y) / map.rows());
+        cellPixels = std::max(cellPixels, MIN_CELL_PIXELS);
+        view.setSize(windowSize.x / cellPixels, windowSize.y / cellPixels);
+        view.setCenter(std::min(view.getSize().x, static_cast<float>(map.cols())) / 2.0f,
+                       std::min(view.getSize().y, static_cast<float>(map.rows())) / 2.0f);
+
+        // A loaded map brings its walls and mud along
+        for (int i = 0; i < map.cellCount(); ++i) {
+            if (!map.passable(i) || map.cost(i) > 1) {
+                renderer.setState(map.cellAt(i), terrainState(map.cellAt(i)));
             }
         }
     }
 
-    void findShortestPath() {
-        // Perform Depth-First Search
-        std::vector<std::vector<bool>> visited(GRID_SIZE, std::vector<bool>(GRID_SIZE, false));
-        parent.resize(GRID_SIZE, std::vector<sf::Vector2i>(GRID_SIZE));
-        std::stack<sf::Vector2i> stk;
-        stk.push(startCell);
-
-        while (!stk.empty()) {
-            sf::Vector2i current = stk.top();
-            stk.pop();
-
-            if (current == endCell) {
-                // Reached the end cell, stop the algorithm
-                break;
-            }
-
-            visited[current.x][current.y] = true;
-
-            // Define the deltas for moving in four directions: up, down, left, and right
-            std::vector<sf::Vector2i> deltas = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    void onVisit(const pathfinder::Cell& cell) override {
+        // Color the visited node, keeping mud distinguishable
+        if (renderer.state(cell) == CellState::Empty) {
+            renderer.setState(cell, CellState::Visited);
+            searchedCells.push_back(cell);
+        } else if (renderer.state(cell) == CellState::Mud) {
+            renderer.setState(cell, CellState::VisitedMud);
+            searchedCells.push_back(cell);
+        }
+    }
 
-            // Iterate over the horizontally and vertically neighboring cells
-            for (const auto& delta : deltas) {
-                sf::Vector2i neighbor(current.x + delta.x, current.y + delta.y);
+    void onVisitFromGoal(const pathfinder::Cell& cell) override {
+        // Bidirectional searches and D* Lite color what grows from the goal separately
+        if (renderer.state(cell) == CellState::Empty) {
+            renderer.setState(cell, CellState::VisitedFromGoal);
+            searchedCells.push_back(cell);
+        } else if (renderer.state(cell) == CellState::Mud) {
+            renderer.setState(cell, CellState::VisitedFromGoalMud);
+            searchedCells.push_back(cell);
+        }
+    }
 
-                // Check if the neighboring cell is within the grid bounds and not a wall
-                if (neighbor.x >= 0 && neighbor.x < GRID_SIZE && neighbor.y >= 0 && neighbor.y < GRID_SIZE &&
-                    !visited[neighbor.x][neighbor.y]) {
-                    parent[neighbor.x][neighbor.y] = current;
-                    grid[neighbor.x][neighbor.y].setFillColor(sf::Color(223,215,200)); // Color the visited node as black
-                    window.clear();
-                    drawGrid(); // Draw the updated grid
-                    window.display();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY_MS)); // Delay for visualization
-                    stk.push(neighbor);
-                }
-            }
+    // How a cell looks when no search has touched it
+    CellState terrainState(const pathfinder::Cell& cell) const {
+        int i = map.index(cell);
+        if (!map.passable(i)) {
+            return CellState::Wall;
         }
-    pathFound=true;
+        return map.cost(i) > 1 ? CellState::Mud : CellState::Empty;
+    }
 
+    void findShortestPath() {
+        searchTimer.reset();
+        colorTimer.reset();
+        searchedCells.clear();
+        goalMoved = false;
+        finder.setMovement(movement);
+        search.reset(new pathfinder::Search(finder.begin(algorithm, startCell, endCell, this)));
     }
 
-    void findAndColorShortestPath() {
-        // Trace back the path from the end cell to the start cell
-        sf::Vector2i current = endCell;
-        while (current != startCell) {
-            grid[current.x][current.y].setFillColor(sf::Color::Yellow);
-            current = parent[current.x][current.y];
+    // Plans every agent at once on the worker pool and starts the animation
+    void planAgentPaths() {
+        if (agents.empty() || goalPending) {
+            return;
         }
+        searchTimer.reset();
+        searchTimer.start();
+        plan.reset(new pathfinder::MultiAgentPlan(pathfinder::planAgents(map, agents, solver, pool)));
+        searchTimer.stop();
+        pathFound = true;
+        agentStep = 0.0f;
+        animationClock.restart();
+        updateTitle();
     }
 
-    void drawGrid() {
-        // Draw the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                window.draw(grid[i][j]);
-            }
+    // Moves the agents on by the time since the last frame at the current
+    // speed, in steps per second
+    void advanceAgents() {
+        float seconds = animationClock.restart().asSeconds();
+        if (!plan || !plan->found) {
+            return;
+        }
+        int speed = SPEED_LEVELS[speedLevel];
+        int shownStep = static_cast<int>(agentStep);
+        agentStep = speed == INSTANT ? plan->makespan
+                                     : std::min(static_cast<float>(plan->makespan), agentStep + speed * seconds);
+        if (static_cast<int>(agentStep) != shownStep) {
+            updateTitle();
         }
     }
 
-    void run() {
-        while (window.isOpen()) {
-            sf::Event event;
-            while (window.pollEvent(event)) {
-                if (event.type == sf::Event::Closed) {
-                    window.close();
-                }
-
-                if (!pathFound && event.type == sf::Event::MouseButtonPressed) {
-                    handleMouseClick(event.mouseButton);
-                }
+    // Only D* Lite can repair its last result after an edit
+    bool incremental() const {
+        return algorithm == pathfinder::Algorithm::DStarLite;
+    }
 
-                if (!pathFound && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
-                    findShortestPath();
-                    findAndColorShortestPath();
-                }
+    // Clears the last result's colors and resumes the search with the edits
+    // made since, so only the cells the repair touches light up. A new goal
+    // invalidates the whole search tree, so that starts over instead.
+    void replan() {
+        for (const pathfinder::Cell& cell : searchedCells) {
+            if (renderer.state(cell) != CellState::Start) {
+                renderer.setState(cell, cell == endCell ? CellState::End : terrainState(cell));
             }
-
-            window.clear();
-            drawGrid();
-            window.display();
         }
+        searchedCells.clear();
+        if (goalMoved) {
+            findShortestPath();
+        } else {
+            searchTimer.reset();
+            colorTimer.reset();
+            search->replan(startCell);
+        }
+        replanPending = false;
+        goalMoved = false;
+        pathFound = false;
+        updateTitle();
     }
-    void handleMouseClick(sf::Event::MouseButtonEvent mouseEvent) {
-        int row = mouseEvent.y / CELL_SIZE;
-        int col = mouseEvent.x / CELL_SIZE;
 
-        if (mouseEvent.button == sf::Mouse::Left) {
-            // Left mouse click sets the start cell
-            startCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(170,219,30));
-        } else if (mouseEvent.button == sf::Mouse::Right) {
-            // Right mouse click sets the end cell
-            endCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(244,54,76));
+    // Runs the pending search for at most one frame's worth of expansions
+    void advanceSearch(int maxExpansions) {
+        sf::Clock clock;
+        searchTimer.start();
+        int expanded = 0;
+        while ((maxExpansions == INSTANT || expanded < maxExpansions) && search->step()) {
+            ++expanded;
+            // Checking the clock is not free, so only look at it every few expansions
+            if (expanded % 64 == 0 && clock.getElapsedTime().asMilliseconds() >= FRAME_BUDGET_MS) {
+                break;
+            }
+        }
+        searchTimer.stop();
+        if (search->done()) {
+            colorTimer.start();
+            findAndColorShortestPath();
+            colorTimer.stop();
+            pathFound = true;
+            updateTitle();
         }
     }
-};
 
-struct Cell {
-    int heuristic;
-    sf::Vector2i coordinates;
-
-    // Define custom comparison operator for the priority queue
-    bool operator<(const Cell& other) const {
-        return heuristic > other.heuristic; // Note: Using > for min-heap behavior
+    void findAndColorShortestPath() {
+        // Color the path from the end cell back to (but not including) the start cell.
+        // Any-angle paths list only their turns, so walk each segment between them.
+        const pathfinder::SearchResult& result = search->result();
+        std::vector<pathfinder::Cell> segment;
+        for (size_t i = 1; i < result.path.size(); ++i) {
+            segment.clear();
+            pathfinder::cellsOnSegment(result.path[i - 1], result.path[i], segment);
+            for (size_t j = 1; j < segment.size(); ++j) {
+                renderer.setState(segment[j], CellState::Path);
+                searchedCells.push_back(segment[j]);
+            }
+        }
     }
-};
 
-class PathfindingVisualizer2 {
-public:
-    PathfindingVisualizer2() : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Pathfinding Visualizer") {
-        initializeGrid();
-        run();
+    bool searching() const {
+        return search && !search->done();
     }
 
-private:
-    sf::RenderWindow window;
-    std::vector<std::vector<sf::RectangleShape>> grid;
-    sf::Vector2i startCell;
-    sf::Vector2i endCell;
-    bool pathFound;
-    std::vector<std::vector<sf::Vector2i>> parent;
-
-    void initializeGrid() {
-        grid.resize(GRID_SIZE, std::vector<sf::RectangleShape>(GRID_SIZE));
+    void setSpeedLevel(int level) {
+        speedLevel = std::max(0, std::min(SPEED_LEVEL_COUNT - 1, level));
+        updateTitle();
+    }
 
-        // Initialize the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                grid[i][j].setSize(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-                grid[i][j].setPosition(j * CELL_SIZE, i * CELL_SIZE);
-                grid[i][j].setFillColor(sf::Color(75,54,95));
-                grid[i][j].setOutlineThickness(1); // Border thickness
-                grid[i][j].setOutlineColor(sf::Color::Black); // Border color
-            }
+    void updateTitle() {
+        if (multiAgent) {
+            updateAgentTitle();
+            return;
+        }
+        std::string title = std::string("Pathfinding Visualizer - ") + pathfinder::algorithmName(algorithm) + " - " +
+                            pathfinder::connectivityName(movement.connectivity);
+        if (movement.connectivity == pathfinder::Connectivity::Eight) {
+            title += std::string(", ") + pathfinder::cornerRuleName(movement.corners);
+        } else if (landmarks && landmarks->current(map) &&
+                   (algorithm == pathfinder::Algorithm::AStar || algorithm == pathfinder::Algorithm::GreedyBestFirst)) {
+            title += ", landmarks";
+        }
+        int speed = SPEED_LEVELS[speedLevel];
+        if (speed == 0) {
+            title += " - paused (N to step)";
+        } else if (speed == INSTANT) {
+            title += " - instant";
+        } else {
+            title += " - " + std::to_string(speed) + " steps/frame";
         }
+        if (search && search->done()) {
+            title += search->result().found ? " - path cost " + std::to_string(search->result().cost) : " - no path";
+        }
+        window.setTitle(title);
     }
 
-    // Heuristic function for Greedy Best-first Search
-    int heuristic(const sf::Vector2i& current) {
-        return abs(current.x - endCell.x) + abs(current.y - endCell.y);
+    void updateAgentTitle() {
+        std::string title = std::string("Pathfinding Visualizer - ") + pathfinder::multiAgentSolverName(solver) +
+                            " - " + std::to_string(agents.size()) + (agents.size() == 1 ? " agent" : " agents");
+        int speed = SPEED_LEVELS[speedLevel];
+        if (speed == 0) {
+            title += " - paused (N to step)";
+        } else if (speed == INSTANT) {
+            title += " - instant";
+        } else {
+            title += " - " + std::to_string(speed) + " steps/s";
+        }
+        if (plan && plan->found) {
+            title += " - step " + std::to_string(static_cast<int>(agentStep)) + "/" +
+                     std::to_string(plan->makespan) + " - cost " + std::to_string(plan->cost);
+        } else if (plan) {
+            title += " - no plan";
+        }
+        if (plan && plan->limitReached) {
+            title += " (CBS node limit, cooperative plan)";
+        }
+        window.setTitle(title);
     }
 
-    void findShortestPath() {
-        // Perform Greedy Best-first Search
-        std::vector<std::vector<bool>> visited(GRID_SIZE, std::vector<bool>(GRID_SIZE, false));
-        parent.resize(GRID_SIZE, std::vector<sf::Vector2i>(GRID_SIZE));
-        std::priority_queue<Cell> pq;
-        pq.push({heuristic(startCell), startCell});
-
-        while (!pq.empty()) {
-            Cell current = pq.top();
-            pq.pop();
-            visited[current.coordinates.x][current.coordinates.y] = true;
-
-            if (current.coordinates == endCell) {
-                // Reached the end cell, stop the algorithm
-                break;
-            }
+    float pixelsPerCell() const {
+        return window.getSize().x / view.getSize().x;
+    }
 
-            // Define the deltas for moving in four directions: up, down, left, and right
-            std::vector<sf::Vector2i> deltas = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    void drawGrid() {
+        drawTimer.reset();
+        drawTimer.start();
+        renderer.draw(window, view, pixelsPerCell());
+        drawAgents();
+        drawTimer.stop();
+    }
 
-            // Explore neighbors
-            for (const auto& delta : deltas) {
-                sf::Vector2i neighbor(current.coordinates.x + delta.x, current.coordinates.y + delta.y);
+    // Each agent's path as a line in its color, its goal as a square outline
+    // and the agent itself as a disc, between two cells while it moves
+    void drawAgents() {
+        if (!multiAgent) {
+            return;
+        }
+        window.setView(view);
+        for (size_t agent = 0; agent < agents.size(); ++agent) {
+            sf::Color color = AGENT_COLORS[agent % AGENT_COLOR_COUNT];
+            const pathfinder::Agent& endpoints = agents[agent];
+            if (agent + 1 < agents.size() || !goalPending) {
+                sf::RectangleShape goal(sf::Vector2f(0.7f, 0.7f));
+                goal.setPosition(endpoints.goal.col + 0.15f, endpoints.goal.row + 0.15f);
+                goal.setFillColor(sf::Color::Transparent);
+                goal.setOutlineColor(color);
+                goal.setOutlineThickness(0.1f);
+                window.draw(goal);
+            }
 
-                // Check if the neighboring cell is within the grid bounds and not a wall
-                if (neighbor.x >= 0 && neighbor.x < GRID_SIZE && neighbor.y >= 0 && neighbor.y < GRID_SIZE &&
-                    !visited[neighbor.x][neighbor.y]) {
-                    parent[neighbor.x][neighbor.y] = current.coordinates;
-                    grid[neighbor.x][neighbor.y].setFillColor(sf::Color(223,215,200)); // Color the visited node as black
-                    window.clear();
-                    drawGrid(); // Draw the updated grid
-                    window.display();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY_MS)); // Delay for visualization
-                    pq.push({heuristic(neighbor), neighbor});
+            sf::Vector2f position(endpoints.start.col + 0.5f, endpoints.start.row + 0.5f);
+            if (plan && plan->found) {
+                const std::vector<pathfinder::Cell>& path = plan->paths[agent];
+                sf::Color lineColor = color;
+                lineColor.a = 160;
+                sf::VertexArray line(sf::LineStrip, path.size());
+                for (size_t step = 0; step < path.size(); ++step) {
+                    line[step] = sf::Vertex(sf::Vector2f(path[step].col + 0.5f, path[step].row + 0.5f), lineColor);
                 }
+                window.draw(line);
+
+                int step = static_cast<int>(agentStep);
+                float along = agentStep - step;
+                const pathfinder::Cell& from = pathfinder::positionAt(path, step);
+                const pathfinder::Cell& to = pathfinder::positionAt(path, step + 1);
+                position = sf::Vector2f(from.col + 0.5f + (to.col - from.col) * along,
+                                        from.row + 0.5f + (to.row - from.row) * along);
             }
+            sf::CircleShape disc(AGENT_RADIUS);
+            disc.setOrigin(AGENT_RADIUS, AGENT_RADIUS);
+            disc.setPosition(position);
+            disc.setFillColor(color);
+            window.draw(disc);
         }
-        pathFound=true;
+        window.setView(window.getDefaultView());
     }
 
-    void findAndColorShortestPath() {
-        // Trace back the path from the end cell to the start cell
-        sf::Vector2i current = endCell;
-        while (current != startCell) {
-            grid[current.x][current.y].setFillColor(sf::Color::Yellow);
-            current = parent[current.x][current.y];
+    void drawStats() {
+        if (!pathfinder::STATS_ENABLED || !showStats || !fontLoaded) {
+            return;
         }
+        std::string lines = "draw " + formatMilliseconds(drawTimer.milliseconds()) + " ms/frame";
+        if (plan) {
+            lines += "\nagents " + std::to_string(agents.size()) +
+                     "\nexpansions " + std::to_string(plan->expansions) +
+                     "\nconflict nodes " + std::to_string(plan->conflictNodes) +
+                     "\nmakespan " + std::to_string(plan->makespan) +
+                     "\nplan " + formatMilliseconds(searchTimer.milliseconds()) + " ms on " +
+                     std::to_string(pool.size()) + (pool.size() == 1 ? " thread" : " threads");
+        }
+        if (search) {
+            const pathfinder::SearchResult& result = search->result();
+            const pathfinder::SearchStats& stats = result.stats;
+            lines += "\nexpansions " + std::to_string(result.expansions) +
+                     "\npushes " + std::to_string(stats.pushes) +
+                     "\nstale pops " + std::to_string(stats.stalePops) +
+                     "\nreopenings " + std::to_string(stats.reopenings) +
+                     "\nmax open " + std::to_string(stats.maxOpenSize) +
+                     "\nsearch " + formatMilliseconds(searchTimer.milliseconds()) + " ms" +
+                     "\npath " + formatMilliseconds(stats.pathMilliseconds) + " ms trace, " +
+                     formatMilliseconds(colorTimer.milliseconds()) + " ms color";
+        }
+
+        sf::Text text(lines, font, STATS_TEXT_SIZE);
+        text.setFillColor(sf::Color::White);
+        text.setPosition(8, 8);
+        sf::FloatRect bounds = text.getGlobalBounds();
+        sf::RectangleShape background(sf::Vector2f(bounds.width + 12, bounds.height + 12));
+        background.setPosition(bounds.left - 6, bounds.top - 6);
+        background.setFillColor(sf::Color(0, 0, 0, 160));
+        window.draw(background);
+        window.draw(text);
     }
 
-    void drawGrid() {
-        // Draw the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                window.draw(grid[i][j]);
-            }
+    // A finished search that found nothing leaves no path on the grid, which
+    // is easy to mistake for a search still running, so say so over the map
+    void drawNoPath() {
+        std::string message;
+        if (plan && !plan->found) {
+            message = "No plan: the agents cannot all reach their goals";
+        } else if (search && search->done() && !search->result().found) {
+            // Zero expansions means the endpoints were walls or in separate regions
+            message = search->result().expansions == 0 ? "No path: start and goal are not connected" : "No path";
+        } else {
+            return;
+        }
+        sf::Vector2f center = window.getView().getCenter();
+        sf::RectangleShape background;
+        background.setFillColor(sf::Color(160, 0, 0, 200));
+        if (fontLoaded) {
+            sf::Text text(message, font, NO_PATH_TEXT_SIZE);
+            text.setFillColor(sf::Color::White);
+            sf::FloatRect local = text.getLocalBounds();
+            text.setOrigin(local.left + local.width / 2.0f, local.top + local.height / 2.0f);
+            text.setPosition(center);
+            sf::FloatRect bounds = text.getGlobalBounds();
+            background.setSize(sf::Vector2f(bounds.width + 32, bounds.height + 24));
+            background.setPosition(bounds.left - 16, bounds.top - 12);
+            window.draw(background);
+            window.draw(text);
+        } else {
+            // Without the font, a red band across the middle still stands out
+            sf::Vector2f size = window.getView().getSize();
+            background.setSize(sf::Vector2f(size.x, 24));
+            background.setPosition(center.x - size.x / 2.0f, center.y - 12);
+            window.draw(background);
+        }
+    }
+
+    static std::string formatMilliseconds(double milliseconds) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2f", milliseconds);
+        return buffer;
+    }
+
+    void zoom(float factor, sf::Vector2i pixel) {
+        // Don't zoom out past MIN_CELL_PIXELS, and keep at least one cell on screen
+        float maxWidth = window.getSize().x / MIN_CELL_PIXELS;
+        float newWidth = view.getSize().x * factor;
+        if (newWidth > maxWidth || newWidth < 1.0f) {
+            return;
         }
+
+        // Keep the cell under the cursor where it is
+        sf::Vector2f before = window.mapPixelToCoords(pixel, view);
+        view.zoom(factor);
+        sf::Vector2f after = window.mapPixelToCoords(pixel, view);
+        view.move(before - after);
+    }
+
+    void pan(float dx, float dy) {
+        view.move(dx, dy);
     }
 
     void run() {
@@ -387,186 +664,323 @@ private:
                     window.close();
                 }
 
-                if (!pathFound && event.type == sf::Event::MouseButtonPressed) {
-                    handleMouseClick(event.mouseButton);
+                if (event.type == sf::Event::Resized) {
+                    // Keep the current zoom level and show more or less of the map
+                    float cellPixels = pixelsPerCell();
+                    view.setSize(event.size.width / cellPixels, event.size.height / cellPixels);
+                    window.setView(sf::View(sf::FloatRect(0, 0, event.size.width, event.size.height)));
+                }
+
+                if (event.type == sf::Event::MouseWheelScrolled) {
+                    zoom(event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f,
+                         sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y));
+                }
+
+                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Middle) {
+                    panning = true;
+                    lastMousePosition = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+                }
+
+                if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Middle) {
+                    panning = false;
+                }
+
+                if (panning && event.type == sf::Event::MouseMoved) {
+                    sf::Vector2i position(event.mouseMove.x, event.mouseMove.y);
+                    pan((lastMousePosition.x - position.x) / pixelsPerCell(),
+                        (lastMousePosition.y - position.y) / pixelsPerCell());
+                    lastMousePosition = position;
+                }
+
+                if (event.type == sf::Event::KeyPressed) {
+                    // Arrow keys pan by a tenth of the view
+                    float stepX = view.getSize().x / 10.0f;
+                    float stepY = view.getSize().y / 10.0f;
+                    if (event.key.code == sf::Keyboard::Left) pan(-stepX, 0);
+                    if (event.key.code == sf::Keyboard::Right) pan(stepX, 0);
+                    if (event.key.code == sf::Keyboard::Up) pan(0, -stepY);
+                    if (event.key.code == sf::Keyboard::Down) pan(0, stepY);
+                }
+
+                if (event.type == sf::Event::KeyPressed) {
+                    handleSpeedKey(event.key.code);
+                    if (event.key.code == sf::Keyboard::I) {
+                        showStats = !showStats;
+                    }
+                }
+
+                if ((!pathFound || incremental()) && !searching()) {
+                    handleEditEvent(event);
                 }
 
-                if (!pathFound && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
-                    findShortestPath();
-                    findAndColorShortestPath();
+                if (!pathFound && !searching() && event.type == sf::Event::KeyPressed &&
+                    event.key.code == sf::Keyboard::Enter) {
+                    if (multiAgent) {
+                        planAgentPaths();
+                    } else {
+                        findShortestPath();
+                    }
+                } else if (plan && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
+                    agentStep = 0.0f;
+                    updateTitle();
+                }
+
+                if (!searching() && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S) {
+                    saveMap();
+                }
+
+                if (!searching() && event.type == sf::Event::KeyPressed) {
+                    handleMovementKey(event.key.code);
                 }
             }
 
+            // A whole stroke is one edit, so wait for the button to come up
+            if (replanPending && !painting && !searching()) {
+                replan();
+            }
+
+            if (searching() && SPEED_LEVELS[speedLevel] != 0) {
+                advanceSearch(SPEED_LEVELS[speedLevel]);
+            }
+            advanceAgents();
+
             window.clear();
             drawGrid();
+            drawNoPath();
+            drawStats();
             window.display();
         }
     }
-    void handleMouseClick(sf::Event::MouseButtonEvent mouseEvent) {
-        int row = mouseEvent.y / CELL_SIZE;
-        int col = mouseEvent.x / CELL_SIZE;
 
-        if (mouseEvent.button == sf::Mouse::Left) {
-            // Left mouse click sets the start cell
-            startCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(170,219,30));
-        } else if (mouseEvent.button == sf::Mouse::Right) {
-            // Right mouse click sets the end cell
-            endCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(244,54,76));
+    // Saves the walls and mud as a binary map next to the file it was loaded
+    // from (city.map becomes city.grid), or to SAVED_MAP_FILE
+    void loadLandmarks() {
+        if (mapFile.empty()) {
+            return;
+        }
+        std::string path = pathfinder::landmarkFileFor(mapFile);
+        if (!std::ifstream(path)) {
+            return;
+        }
+        try {
+            landmarks.reset(new pathfinder::LandmarkTable(pathfinder::loadLandmarkFile(path, map)));
+            finder.setLandmarks(landmarks.get());
+            std::cout << "loaded " << landmarks->count() << " landmarks from " << path << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
         }
     }
-};
 
-struct Compare {
-    bool operator()(const std::pair<int, sf::Vector2i>& a, const std::pair<int, sf::Vector2i>& b) const {
-        // Compare based on the first element of the pairs
-        return a.first > b.first;
+    void saveMap() {
+        std::string path = SAVED_MAP_FILE;
+        if (!mapFile.empty()) {
+            size_t extension = mapFile.find_last_of('.');
+            if (extension == std::string::npos || mapFile.find_first_of("/\\", extension) != std::string::npos) {
+                extension = mapFile.size();
+            }
+            path = mapFile.substr(0, extension) + ".grid";
+        }
+        try {
+            pathfinder::saveGridFile(map, path);
+            std::cout << "saved map to " << path << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
     }
-};
-
 
-class PathfindingVisualizer3 {
-public:
-    PathfindingVisualizer3() : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Pathfinding Visualizer") {
-        initializeGrid();
-        run();
+    void handleSpeedKey(sf::Keyboard::Key key) {
+        if (key == sf::Keyboard::Add || key == sf::Keyboard::Equal) {
+            setSpeedLevel(speedLevel + 1);
+        } else if (key == sf::Keyboard::Subtract || key == sf::Keyboard::Hyphen) {
+            setSpeedLevel(speedLevel - 1);
+        } else if (key == sf::Keyboard::Space) {
+            // Pause, or resume at the speed used before pausing
+            if (speedLevel != 0) {
+                resumeSpeedLevel = speedLevel;
+                setSpeedLevel(0);
+            } else {
+                setSpeedLevel(resumeSpeedLevel);
+            }
+        } else if (key == sf::Keyboard::N && searching() && SPEED_LEVELS[speedLevel] == 0) {
+            advanceSearch(1);
+        } else if (key == sf::Keyboard::N && plan && plan->found && SPEED_LEVELS[speedLevel] == 0) {
+            agentStep = std::min(static_cast<float>(plan->makespan), std::floor(agentStep) + 1.0f);
+            updateTitle();
+        }
     }
 
-private:
-    sf::RenderWindow window;
-    std::vector<std::vector<sf::RectangleShape>> grid;
-    sf::Vector2i startCell;
-    sf::Vector2i endCell;
-    bool pathFound;
-    std::vector<std::vector<sf::Vector2i>> parent;
-
-    void initializeGrid() {
-        grid.resize(GRID_SIZE, std::vector<sf::RectangleShape>(GRID_SIZE));
-
-        // Initialize the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                grid[i][j].setSize(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-                grid[i][j].setPosition(j * CELL_SIZE, i * CELL_SIZE);
-                grid[i][j].setFillColor(sf::Color(75,54,95));
-                grid[i][j].setOutlineThickness(1); // Border thickness
-                grid[i][j].setOutlineColor(sf::Color::Black); // Border color
+    // Takes effect with the next search; agents always move four ways
+    void handleMovementKey(sf::Keyboard::Key key) {
+        if (multiAgent) {
+            return;
+        }
+        if (key == sf::Keyboard::D) {
+            movement.connectivity = movement.connectivity == pathfinder::Connectivity::Four
+                                        ? pathfinder::Connectivity::Eight
+                                        : pathfinder::Connectivity::Four;
+        } else if (key == sf::Keyboard::C) {
+            // Strictest first: no corner cutting, then no squeezing, then cut freely
+            if (movement.corners == pathfinder::CornerRule::NoCut) {
+                movement.corners = pathfinder::CornerRule::NoSqueeze;
+            } else if (movement.corners == pathfinder::CornerRule::NoSqueeze) {
+                movement.corners = pathfinder::CornerRule::Cut;
+            } else {
+                movement.corners = pathfinder::CornerRule::NoCut;
             }
+        } else {
+            return;
         }
+        updateTitle();
     }
 
-    // Heuristic function for A* algorithm
-    int heuristic(const sf::Vector2i& current) {
-        return abs(current.x - endCell.x) + abs(current.y - endCell.y);
+    pathfinder::Cell cellAtPixel(int x, int y) const {
+        sf::Vector2f position = window.mapPixelToCoords(sf::Vector2i(x, y), view);
+        return pathfinder::Cell{static_cast<int>(std::floor(position.y)), static_cast<int>(std::floor(position.x))};
     }
 
-    void findShortestPath() {
-    // Perform A* algorithm
-    
-    parent.resize(GRID_SIZE, std::vector<sf::Vector2i>(GRID_SIZE, sf::Vector2i(-1, -1)));
-    std::priority_queue<std::pair<int, sf::Vector2i>, std::vector<std::pair<int, sf::Vector2i>>, Compare> pq;
-    pq.push({heuristic(startCell), startCell});
-     std::vector<std::vector<bool>> visited(GRID_SIZE, std::vector<bool>(GRID_SIZE, false));
-     std::vector<std::vector<int>> distance(GRID_SIZE, std::vector<int>(GRID_SIZE, std::numeric_limits<int>::max()));
-        distance[startCell.x][startCell.y] = 0;
-
-    while (!pq.empty()) {
-        sf::Vector2i current = pq.top().second;
-        pq.pop();
-
-        if (current == endCell) {
-            // Reached the end cell, stop the algorithm
-            break;
-        }
-
-        // Define the deltas for moving in four directions: up, down, left, and right
-        std::vector<sf::Vector2i> deltas = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
-
-        // Iterate over the horizontally and vertically neighboring cells
-        for (const auto& delta : deltas) {
-            sf::Vector2i neighbor(current.x + delta.x, current.y + delta.y);
-
-            // Check if the neighboring cell is within the grid bounds and not a wall
-            if (neighbor.x >= 0 && neighbor.x < GRID_SIZE && neighbor.y >= 0 && neighbor.y < GRID_SIZE) {
-                int newDistance = distance[current.x][current.y] + 1;
-
-                if (newDistance < distance[neighbor.x][neighbor.y]) {
-                    distance[neighbor.x][neighbor.y] = newDistance;
-                    parent[neighbor.x][neighbor.y] = current;
-                    grid[neighbor.x][neighbor.y].setFillColor(sf::Color(223,215,200)); // Color the visited node as blue
-                    pq.push({newDistance + heuristic(neighbor), neighbor});
-                    window.clear();
-                    drawGrid(); // Draw the updated grid
-                    window.display();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY_MS)); // Delay for visualization
-                }
+    void handleEditEvent(const sf::Event& event) {
+        if (event.type == sf::Event::KeyPressed) {
+            if (event.key.code == sf::Keyboard::Num1) brush = Brush::Endpoints;
+            if (event.key.code == sf::Keyboard::Num2) brush = Brush::Wall;
+            if (event.key.code == sf::Keyboard::Num3) brush = Brush::Mud;
+        }
+
+        bool buttonEvent = event.type == sf::Event::MouseButtonPressed || event.type == sf::Event::MouseButtonReleased;
+        bool paintButton = buttonEvent && (event.mouseButton.button == sf::Mouse::Left ||
+                                           event.mouseButton.button == sf::Mouse::Right);
+        if (event.type == sf::Event::MouseButtonPressed && paintButton) {
+            if (brush == Brush::Endpoints) {
+                handleMouseClick(event.mouseButton);
+                return;
+            }
+            painting = true;
+            erasing = event.mouseButton.button == sf::Mouse::Right;
+            fillingRectangle = sf::Keyboard::isKeyPressed(sf::Keyboard::LShift) ||
+                               sf::Keyboard::isKeyPressed(sf::Keyboard::RShift);
+            strokeStart = lastPaintedCell = cellAtPixel(event.mouseButton.x, event.mouseButton.y);
+            if (!fillingRectangle) {
+                paintCell(strokeStart);
             }
+        } else if (event.type == sf::Event::MouseMoved && painting && !fillingRectangle) {
+            pathfinder::Cell cell = cellAtPixel(event.mouseMove.x, event.mouseMove.y);
+            paintLine(lastPaintedCell, cell);
+            lastPaintedCell = cell;
+        } else if (event.type == sf::Event::MouseButtonReleased && painting && paintButton) {
+            if (fillingRectangle) {
+                paintRectangle(strokeStart, cellAtPixel(event.mouseButton.x, event.mouseButton.y));
+            }
+            painting = false;
         }
     }
-    pathFound = true;
-}
 
-
-    void findAndColorShortestPath() {
-        // Trace back the path from the end cell to the start cell
-        sf::Vector2i current = endCell;
-        while (current != startCell) {
-            grid[current.x][current.y].setFillColor(sf::Color::Yellow);
-            current = parent[current.x][current.y];
+    // Writes the brush (or an erase) into the engine's grid and the renderer.
+    // Only the touched cell changes, so strokes cost O(painted cells).
+    void paintCell(const pathfinder::Cell& cell) {
+        if (!map.contains(cell)) {
+            return;
+        }
+        CellState current = renderer.state(cell);
+        // A finished path is drawn over the end cell, which stays unpaintable
+        if (current == CellState::Start || current == CellState::End || (pathFound && cell == endCell)) {
+            return;
+        }
+        bool passable = erasing || brush != Brush::Wall;
+        int cost = (!erasing && brush == Brush::Mud) ? MUD_COST : 1;
+        map.setCell(cell, passable, cost);
+        renderer.setState(cell, terrainState(cell));
+        if (pathFound) {
+            replanPending = true;
         }
     }
 
-    void drawGrid() {
-        // Draw the grid
-        for (int i = 0; i < GRID_SIZE; ++i) {
-            for (int j = 0; j < GRID_SIZE; ++j) {
-                window.draw(grid[i][j]);
-            }
+    // Fast mouse moves skip cells, so fill in the straight line between samples
+    void paintLine(const pathfinder::Cell& from, const pathfinder::Cell& to) {
+        int steps = std::max(std::abs(to.row - from.row), std::abs(to.col - from.col));
+        for (int i = 1; i <= steps; ++i) {
+            paintCell(pathfinder::Cell{from.row + (to.row - from.row) * i / steps,
+                                       from.col + (to.col - from.col) * i / steps});
         }
     }
 
-    void run() {
-        while (window.isOpen()) {
-            sf::Event event;
-            while (window.pollEvent(event)) {
-                if (event.type == sf::Event::Closed) {
-                    window.close();
-                }
-
-                if (!pathFound && event.type == sf::Event::MouseButtonPressed) {
-                    handleMouseClick(event.mouseButton);
-                }
-
-                if (!pathFound && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Enter) {
-                    findShortestPath();
-                    findAndColorShortestPath();
-                }
+    void paintRectangle(const pathfinder::Cell& corner, const pathfinder::Cell& oppositeCorner) {
+        int top = std::max(0, std::min(corner.row, oppositeCorner.row));
+        int bottom = std::min(map.rows() - 1, std::max(corner.row, oppositeCorner.row));
+        int left = std::max(0, std::min(corner.col, oppositeCorner.col));
+        int right = std::min(map.cols() - 1, std::max(corner.col, oppositeCorner.col));
+        for (int row = top; row <= bottom; ++row) {
+            for (int col = left; col <= right; ++col) {
+                paintCell(pathfinder::Cell{row, col});
             }
-
-            window.clear();
-            drawGrid();
-            window.display();
         }
     }
+
     void handleMouseClick(sf::Event::MouseButtonEvent mouseEvent) {
-        int row = mouseEvent.y / CELL_SIZE;
-        int col = mouseEvent.x / CELL_SIZE;
+        pathfinder::Cell cell = cellAtPixel(mouseEvent.x, mouseEvent.y);
+        if (!map.contains(cell)) {
+            return;
+        }
+        // Start and end cells must be passable, placing one on a wall removes it
+        if (!map.passable(map.index(cell))) {
+            map.setCell(cell, true);
+        }
+        if (multiAgent) {
+            placeAgentEndpoint(mouseEvent.button, cell);
+            return;
+        }
 
         if (mouseEvent.button == sf::Mouse::Left) {
-            // Left mouse click sets the start cell
-            startCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(170,219,30));
+            // Left mouse click moves the start cell
+            if (renderer.state(startCell) == CellState::Start) {
+                renderer.setState(startCell, terrainState(startCell));
+            }
+            startCell = cell;
+            renderer.setState(cell, CellState::Start);
         } else if (mouseEvent.button == sf::Mouse::Right) {
-            // Right mouse click sets the end cell
-            endCell = sf::Vector2i(row, col);
-            grid[row][col].setFillColor(sf::Color(244,54,76));
+            // Right mouse click moves the end cell
+            if (renderer.state(endCell) == CellState::End) {
+                renderer.setState(endCell, terrainState(endCell));
+            }
+            endCell = cell;
+            renderer.setState(cell, CellState::End);
+            goalMoved = true;
+        }
+        if (pathFound) {
+            replanPending = true;
+        }
+    }
+
+    // Left places a new agent's start, or moves it while its goal is still
+    // missing; right places the goal of the last agent
+    void placeAgentEndpoint(sf::Mouse::Button button, const pathfinder::Cell& cell) {
+        CellState current = renderer.state(cell);
+        if (current == CellState::Start || current == CellState::End) {
+            return; // Agents need starts and goals of their own
+        }
+        if (button == sf::Mouse::Left) {
+            if (goalPending) {
+                renderer.setState(agents.back().start, terrainState(agents.back().start));
+                agents.back().start = cell;
+            } else {
+                agents.push_back(pathfinder::Agent{cell, cell});
+                goalPending = true;
+            }
+            renderer.setState(cell, CellState::Start);
+        } else if (button == sf::Mouse::Right && !agents.empty()) {
+            if (!goalPending) {
+                renderer.setState(agents.back().goal, terrainState(agents.back().goal));
+            }
+            agents.back().goal = cell;
+            goalPending = false;
+            renderer.setState(cell, CellState::End);
         }
+        updateTitle();
     }
 };
+
 class MainVisualizerPage {
 public:
-    MainVisualizerPage() : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Main Page") {
+    MainVisualizerPage(const pathfinder::Grid& map, const std::string& mapFile)
+        : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Main Page"), map(map), mapFile(mapFile) {
         createButtons();
         run();
     }
@@ -574,14 +988,17 @@ public:
 private:
     sf::RenderWindow window;
     std::vector<sf::RectangleShape> buttons;
+    const pathfinder::Grid& map;
+    std::string mapFile;
 
     void createButtons() {
         sf::Vector2f buttonSize(200, 50);
-        sf::Vector2f buttonPosition(300, 200);
+        sf::Vector2f buttonPosition(150, 130);
 
-        for (int i = 0; i < 4; ++i) {
+        // Two columns of buttons
+        for (int i = 0; i < 14; ++i) {
             sf::RectangleShape button(buttonSize);
-            button.setPosition(buttonPosition.x, buttonPosition.y + i * 100);
+            button.setPosition(buttonPosition.x + (i % 2) * 300, buttonPosition.y + (i / 2) * 100);
             button.setFillColor(sf::Color(0,124,128));
             buttons.push_back(button);
         }
@@ -609,7 +1026,7 @@ private:
 
         // Create text for the buttons
         sf::Font font;
-        font.loadFromFile("fonts/times new roman.ttf");
+        font.loadFromFile(FONT_FILE);
 
         // Draw the text on the buttons
         for (int i = 0; i < buttons.size(); ++i) {
@@ -631,6 +1048,46 @@ private:
             {
                 buttonText.setString("A*");
             }
+            else if(i==4)
+            {
+                buttonText.setString("JPS");
+            }
+            else if(i==5)
+            {
+                buttonText.setString("JPS+");
+            }
+            else if(i==6)
+            {
+                buttonText.setString("BIDIR. DJIKTRA'S");
+            }
+            else if(i==7)
+            {
+                buttonText.setString("BIDIRECTIONAL A*");
+            }
+            else if(i==8)
+            {
+                buttonText.setString("HPA*");
+            }
+            else if(i==9)
+            {
+                buttonText.setString("D* LITE");
+            }
+            else if(i==10)
+            {
+                buttonText.setString("THETA*");
+            }
+            else if(i==11)
+            {
+                buttonText.setString("LAZY THETA*");
+            }
+            else if(i==12)
+            {
+                buttonText.setString("COOPERATIVE A*");
+            }
+            else if(i==13)
+            {
+                buttonText.setString("CBS (AGENTS)");
+            }
             buttonText.setCharacterSize(20); // Set text size
             buttonText.setFillColor(sf::Color::White); // Set text color
             buttonText.setStyle(sf::Text::Bold); // Set text style (bold)
@@ -662,28 +1119,99 @@ private:
     void handleButtonClick(size_t buttonIndex) {
         if (buttonIndex == 0) {
             // Djikstra's Algorithm button clicked, navigate to Pathfinding Visualizer
-            PathfindingVisualizer visualizer;
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::Dijkstra, map, mapFile);
             window.close(); // Close the main page window
         }
         if (buttonIndex == 1) {
             // DFS Algorithm button clicked, navigate to Pathfinding Visualizer
-            PathfindingVisualizer1 visualizer;
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::DepthFirst, map, mapFile);
             window.close(); // Close the main page window
         }
         if (buttonIndex == 2) {
             // greedy best fit Algorithm button clicked, navigate to Pathfinding Visualizer
-            PathfindingVisualizer2 visualizer;
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::GreedyBestFirst, map, mapFile);
             window.close(); // Close the main page window
         }
         if (buttonIndex == 3) {
             // A* Algorithm button clicked, navigate to Pathfinding Visualizer
-            PathfindingVisualizer3 visualizer;
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::AStar, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 4) {
+            // Jump Point Search button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::JumpPoint, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 5) {
+            // JPS+ button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::JumpPointPlus, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 6) {
+            // Bidirectional Djikstra's button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::BidirectionalDijkstra, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 7) {
+            // Bidirectional A* button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::BidirectionalAStar, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 8) {
+            // HPA* button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::Hierarchical, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 9) {
+            // D* Lite button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::DStarLite, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 10) {
+            // Theta* button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::ThetaStar, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 11) {
+            // Lazy Theta* button clicked, navigate to Pathfinding Visualizer
+            PathfindingVisualizer visualizer(pathfinder::Algorithm::LazyThetaStar, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 12) {
+            // Cooperative A* button clicked, navigate to Pathfinding Visualizer with several agents
+            PathfindingVisualizer visualizer(pathfinder::MultiAgentSolver::Cooperative, map, mapFile);
+            window.close(); // Close the main page window
+        }
+        if (buttonIndex == 13) {
+            // CBS button clicked, navigate to Pathfinding Visualizer with several agents
+            PathfindingVisualizer visualizer(pathfinder::MultiAgentSolver::ConflictBased, map, mapFile);
             window.close(); // Close the main page window
         }
     }
 };
 
-int main() {
-    MainVisualizerPage mainPage;
+int main(int argc, char* argv[]) {
+    // The map is chosen at launch: pathfinder [rows cols | map-file]
+    int rows = DEFAULT_GRID_SIZE;
+    int cols = DEFAULT_GRID_SIZE;
+    std::string mapFile;
+    if (argc == 3) {
+        rows = std::atoi(argv[1]);
+        cols = std::atoi(argv[2]);
+    } else if (argc == 2) {
+        mapFile = argv[1];
+    }
+    if (argc > 3 || rows <= 0 || cols <= 0) {
+        std::cerr << "usage: " << argv[0] << " [rows cols | map-file]" << std::endl;
+        return 1;
+    }
+
+    try {
+        pathfinder::Grid map = mapFile.empty() ? pathfinder::Grid(rows, cols) : pathfinder::loadMap(mapFile);
+        MainVisualizerPage mainPage(map, mapFile);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
     return 0;
 }
@@ -0,0 +1,162 @@
+// Plans many agents on one map at once (engine/multi_agent.hpp) and prints
+// one line per agent, in input order:
+//
+//     <agent> <cost> <steps>
+//
+// followed, with -p, by the agent's cells one step at a time as "row,col".
+// Agents are read from the agents file, one per line as "startRow startCol
+// goalRow goalCol", or with -n placed at random open cells (distinct starts
+// and goals in the same region, seeded with -r). -s picks the solver:
+// cbs (lowest sum of costs, the default) or cooperative. CBS gives up after
+// -l plans and prints the Cooperative A* plan instead, saying so in the
+// summary. The plan is checked for conflicts before it is printed; a summary
+// goes to standard error.
+//
+// Build: g++ -std=c++17 -O2 -pthread -I. tools/agents.cpp -o agents
+// Usage: agents [-s cbs|cooperative] [-t threads] [-l node-limit] [-n count] [-r seed] [-p] map-file [agents-file]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "engine/components.hpp"
+#include "engine/map_io.hpp"
+#include "engine/multi_agent.hpp"
+
+namespace {
+
+void printUsage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [-s cbs|cooperative] [-t threads] [-l node-limit] [-n count] [-r seed] [-p] map-file "
+                 "[agents-file]\n",
+                 program);
+}
+
+pathfinder::Cell randomPassableCell(const pathfinder::Grid& grid, std::mt19937& rng) {
+    while (true) {
+        pathfinder::Cell cell{static_cast<int>(rng() % grid.rows()), static_cast<int>(rng() % grid.cols())};
+        if (grid.passable(grid.index(cell))) {
+            return cell;
+        }
+    }
+}
+
+std::vector<pathfinder::Agent> randomAgents(const pathfinder::Grid& grid, int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    pathfinder::ComponentMap components(grid);
+    std::unordered_set<int> starts;
+    std::unordered_set<int> goals;
+    std::vector<pathfinder::Agent> agents;
+    while (static_cast<int>(agents.size()) < count) {
+        pathfinder::Agent agent{randomPassableCell(grid, rng), randomPassableCell(grid, rng)};
+        int start = grid.index(agent.start);
+        int goal = grid.index(agent.goal);
+        if (components.connected(start, goal) && !starts.count(start) && !goals.count(goal)) {
+            starts.insert(start);
+            goals.insert(goal);
+            agents.push_back(agent);
+        }
+    }
+    return agents;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    pathfinder::MultiAgentSolver solver = pathfinder::MultiAgentSolver::ConflictBased;
+    int threadCount = 0;
+    int nodeLimit = pathfinder::CBS_NODE_LIMIT;
+    int randomCount = 0;
+    unsigned seed = 1;
+    bool printPaths = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-s" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "cbs") {
+                solver = pathfinder::MultiAgentSolver::ConflictBased;
+            } else if (name == "cooperative") {
+                solver = pathfinder::MultiAgentSolver::Cooperative;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (argument == "-t" && i + 1 < argc) {
+            threadCount = std::atoi(argv[++i]);
+        } else if (argument == "-l" && i + 1 < argc) {
+            nodeLimit = std::atoi(argv[++i]);
+        } else if (argument == "-n" && i + 1 < argc) {
+            randomCount = std::atoi(argv[++i]);
+        } else if (argument == "-r" && i + 1 < argc) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "-p") {
+            printPaths = true;
+        } else {
+            files.push_back(argument);
+        }
+    }
+    if (files.empty() || files.size() > 2 || (files.size() == 2) == (randomCount > 0) || threadCount < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        pathfinder::Grid grid = pathfinder::loadMap(files[0]);
+        std::vector<pathfinder::Agent> agents;
+        if (randomCount > 0) {
+            agents = randomAgents(grid, randomCount, seed);
+        } else {
+            std::ifstream in(files[1]);
+            if (!in) {
+                std::fprintf(stderr, "cannot open agents file %s\n", files[1].c_str());
+                return 1;
+            }
+            pathfinder::Agent agent;
+            while (in >> agent.start.row >> agent.start.col >> agent.goal.row >> agent.goal.col) {
+                agents.push_back(agent);
+            }
+        }
+
+        pathfinder::ThreadPool pool(threadCount);
+        auto start = std::chrono::steady_clock::now();
+        pathfinder::MultiAgentPlan plan = pathfinder::planAgents(grid, agents, solver, pool, nodeLimit);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        const char* limitNote = plan.limitReached ? ", node limit reached, Cooperative A* fallback" : "";
+        if (!plan.found) {
+            std::fprintf(stderr, "%zu agents, %s: no plan%s (%d expansions, %d conflict nodes, %.2f ms)\n",
+                         agents.size(), pathfinder::multiAgentSolverName(solver), limitNote, plan.expansions,
+                         plan.conflictNodes, ms);
+            return 1;
+        }
+        pathfinder::AgentConflict conflict = pathfinder::findConflict(grid, plan.paths);
+        if (conflict.first >= 0) {
+            std::fprintf(stderr, "agents %d and %d collide at step %d\n", conflict.first, conflict.second,
+                         conflict.step);
+            return 1;
+        }
+        for (size_t agent = 0; agent < plan.paths.size(); ++agent) {
+            std::printf("%zu %d %zu", agent, plan.costs[agent], plan.paths[agent].size() - 1);
+            if (printPaths) {
+                for (const pathfinder::Cell& cell : plan.paths[agent]) {
+                    std::printf(" %d,%d", cell.row, cell.col);
+                }
+            }
+            std::printf("\n");
+        }
+        std::fprintf(stderr, "%zu agents, %s%s, %d threads: cost %d, makespan %d | %d expansions, %d conflict nodes, "
+                     "%.2f ms\n", agents.size(), pathfinder::multiAgentSolverName(solver), limitNote, pool.size(),
+                     plan.cost, plan.makespan, plan.expansions, plan.conflictNodes, ms);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Compares the engine's A* against the A* the visualizer used to ship: a
+// std::priority_queue of (f, cell) pairs with no closed set, which pushed
+// duplicates, re-expanded stale entries and broke ties on f arbitrarily.
+// On uniform-cost maps it also runs JPS and JPS+ against the engine's A*.
+//
+// Build: g++ -std=c++17 -O2 -I. tools/astar_bench.cpp -o astar_bench
+// Usage: astar_bench [queries per map]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "engine/search.hpp"
+
+namespace {
+
+struct LegacyResult {
+    bool found = false;
+    int cost = 0;
+    int expansions = 0;
+};
+
+// The old PathfindingVisualizer3::findShortestPath, minus the drawing
+LegacyResult legacyAStar(const pathfinder::Grid& grid, const pathfinder::Cell& start, const pathfinder::Cell& goal) {
+    LegacyResult result;
+    std::vector<int> distance(grid.cellCount(), std::numeric_limits<int>::max());
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
+    pq.push({pathfinder::detail::manhattan(start, goal), grid.index(start)});
+    distance[grid.index(start)] = 0;
+
+    while (!pq.empty()) {
+        int current = pq.top().second;
+        pq.pop();
+        ++result.expansions;
+
+        if (current == grid.index(goal)) {
+            result.found = true;
+            result.cost = distance[current];
+            break;
+        }
+
+        pathfinder::Cell cell = grid.cellAt(current);
+        for (const pathfinder::Cell& delta : pathfinder::detail::DELTAS) {
+            pathfinder::Cell neighbor{cell.row + delta.row, cell.col + delta.col};
+            if (!grid.contains(neighbor) || !grid.passable(grid.index(neighbor))) {
+                continue;
+            }
+            int next = grid.index(neighbor);
+            int newDistance = distance[current] + grid.cost(next);
+            if (newDistance < distance[next]) {
+                distance[next] = newDistance;
+                pq.push({newDistance + pathfinder::detail::manhattan(neighbor, goal), next});
+            }
+        }
+    }
+    return result;
+}
+
+struct Query {
+    pathfinder::Cell start;
+    pathfinder::Cell goal;
+};
+
+pathfinder::Cell randomPassableCell(const pathfinder::Grid& grid, std::mt19937& rng) {
+    while (true) {
+        pathfinder::Cell cell{static_cast<int>(rng() % grid.rows()), static_cast<int>(rng() % grid.cols())};
+        if (grid.passable(grid.index(cell))) {
+            return cell;
+        }
+    }
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool benchmarkMap(const char* name, const pathfinder::Grid& grid, int queryCount, std::mt19937& rng) {
+    std::vector<Query> queries;
+    for (int i = 0; i < queryCount; ++i) {
+        queries.push_back(Query{randomPassableCell(grid, rng), randomPassableCell(grid, rng)});
+    }
+
+    long long legacyExpansions = 0;
+    long long expansions = 0;
+    std::vector<LegacyResult> legacyResults;
+    auto legacyStart = std::chrono::steady_clock::now();
+    for (const Query& query : queries) {
+        legacyResults.push_back(legacyAStar(grid, query.start, query.goal));
+        legacyExpansions += legacyResults.back().expansions;
+    }
+    double legacyMs = millisecondsSince(legacyStart);
+
+    pathfinder::PathFinder finder(grid);
+    bool agree = true;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        pathfinder::SearchResult result = finder.findPath(pathfinder::Algorithm::AStar, queries[i].start, queries[i].goal);
+        expansions += result.expansions;
+        agree = agree && result.found == legacyResults[i].found && result.cost == legacyResults[i].cost;
+    }
+    double ms = millisecondsSince(start);
+
+    std::printf("%-24s legacy %10.2f ms %12lld exp | engine %10.2f ms %12lld exp | %6.1fx faster %6.1fx fewer exp%s\n",
+                name, legacyMs / queryCount, legacyExpansions / queryCount, ms / queryCount, expansions / queryCount,
+                legacyMs / ms, static_cast<double>(legacyExpansions) / std::max(1LL, expansions),
+                agree ? "" : "  COST MISMATCH");
+
+    if (grid.uniformCost()) {
+        const pathfinder::Algorithm jumpAlgorithms[] = {pathfinder::Algorithm::JumpPoint,
+                                                        pathfinder::Algorithm::JumpPointPlus};
+        for (pathfinder::Algorithm algorithm : jumpAlgorithms) {
+            // Build the JPS+ table outside the timed loop
+            finder.findPath(algorithm, queries[0].start, queries[0].start);
+            long long jumpExpansions = 0;
+            bool jumpAgree = true;
+            auto jumpStart = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < queries.size(); ++i) {
+                pathfinder::SearchResult result = finder.findPath(algorithm, queries[i].start, queries[i].goal);
+                jumpExpansions += result.expansions;
+                jumpAgree = jumpAgree && result.found == legacyResults[i].found && result.cost == legacyResults[i].cost;
+            }
+            double jumpMs = millisecondsSince(jumpStart);
+            std::printf("%-24s %-6s %10.2f ms %12lld exp | vs engine A*: %6.2fx faster %6.1fx fewer exp%s\n", "",
+                        pathfinder::algorithmName(algorithm), jumpMs / queryCount, jumpExpansions / queryCount,
+                        ms / jumpMs, static_cast<double>(expansions) / std::max(1LL, jumpExpansions),
+                        jumpAgree ? "" : "  COST MISMATCH");
+            agree = agree && jumpAgree;
+        }
+    }
+    return agree;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int queryCount = argc > 1 ? std::atoi(argv[1]) : 20;
+    if (queryCount <= 0) {
+        std::fprintf(stderr, "usage: %s [queries per map]\n", argv[0]);
+        return 1;
+    }
+    std::mt19937 rng(12345);
+    bool ok = true;
+
+    std::printf("per-query averages over %d random queries\n", queryCount);
+
+    pathfinder::Grid open1k(1024, 1024);
+    ok = benchmarkMap("open 1024x1024", open1k, queryCount, rng) && ok;
+
+    pathfinder::Grid open2k(2048, 2048);
+    ok = benchmarkMap("open 2048x2048", open2k, queryCount, rng) && ok;
+
+    pathfinder::Grid scattered(1024, 1024);
+    for (int i = 0; i < scattered.cellCount(); ++i) {
+        if (rng() % 100 < 20) {
+            scattered.setCell(scattered.cellAt(i), false);
+        }
+    }
+    ok = benchmarkMap("20% walls 1024x1024", scattered, queryCount, rng) && ok;
+
+    pathfinder::Grid terrain(1024, 1024);
+    for (int i = 0; i < terrain.cellCount(); ++i) {
+        terrain.setCell(terrain.cellAt(i), true, 1 + static_cast<int>(rng() % 4));
+    }
+    ok = benchmarkMap("weighted 1-4 1024x1024", terrain, queryCount, rng) && ok;
+
+    return ok ? 0 : 1;
+}
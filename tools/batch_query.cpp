@@ -0,0 +1,174 @@
+// Runs a batch of start/goal queries against one map on a pool of worker
+// threads and prints one result line per query, in input order:
+//
+//     <query> <found 0|1> <cost> <expansions>
+//
+// Queries are read from the queries file (or standard input), one per line as
+// "startRow startCol goalRow goalCol". The map may be a MovingAI .map, a .pgm
+// occupancy image or a binary .grid file. With -8 paths may also step
+// diagonally (without cutting corners) and the cost has a fractional part.
+// With -L, A* and greedy best-first use the landmarks saved next to the map
+// by tools/landmarks.cpp. With -C, queries go through a PathCache of the given
+// capacity (engine/path_cache.hpp), so repeated queries and queries along an
+// earlier path skip the search and report 0 expansions. A summary goes to
+// standard error.
+//
+// -m computes a distance matrix instead (pathfinder::distanceMatrix()): the
+// queries' starts are its sources and their goals its targets, and the output
+// has one line per start with the costs to every goal, "-" where there is no
+// path.
+//
+// Build: g++ -std=c++17 -O2 -pthread -I. tools/batch_query.cpp -o batch_query
+// Usage: batch_query [-t threads] [-a algorithm] [-8] [-L] [-C capacity] [-m] map-file [queries-file]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/batch.hpp"
+#include "engine/landmarks.hpp"
+#include "engine/map_io.hpp"
+#include "engine/path_cache.hpp"
+#include "engine/search.hpp"
+
+namespace {
+
+void printUsage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [-t threads] [-a algorithm] [-8] [-L] [-C capacity] [-m] map-file [queries-file]\n"
+                 "algorithms:",
+                 program);
+    for (pathfinder::Algorithm algorithm : pathfinder::ALGORITHMS) {
+        std::fprintf(stderr, " %s", pathfinder::algorithmId(algorithm));
+    }
+    std::fprintf(stderr, "\n");
+}
+
+std::vector<pathfinder::Query> readQueries(std::istream& in) {
+    std::vector<pathfinder::Query> queries;
+    pathfinder::Query query;
+    while (in >> query.start.row >> query.start.col >> query.goal.row >> query.goal.col) {
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int threadCount = 0;
+    pathfinder::Algorithm algorithm = pathfinder::Algorithm::AStar;
+    pathfinder::Movement movement;
+    bool useLandmarks = false;
+    int cacheCapacity = 0;
+    bool matrix = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-t" && i + 1 < argc) {
+            threadCount = std::atoi(argv[++i]);
+        } else if (argument == "-a" && i + 1 < argc) {
+            if (!pathfinder::parseAlgorithm(argv[++i], algorithm)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (argument == "-8") {
+            movement.connectivity = pathfinder::Connectivity::Eight;
+        } else if (argument == "-L") {
+            useLandmarks = true;
+        } else if (argument == "-C" && i + 1 < argc) {
+            cacheCapacity = std::atoi(argv[++i]);
+        } else if (argument == "-m") {
+            matrix = true;
+        } else {
+            files.push_back(argument);
+        }
+    }
+    if (files.empty() || files.size() > 2 || threadCount < 0 || cacheCapacity < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        pathfinder::Grid grid = pathfinder::loadMap(files[0]);
+        std::vector<pathfinder::Query> queries;
+        if (files.size() == 2) {
+            std::ifstream in(files[1]);
+            if (!in) {
+                std::fprintf(stderr, "cannot open queries file %s\n", files[1].c_str());
+                return 1;
+            }
+            queries = readQueries(in);
+        } else {
+            queries = readQueries(std::cin);
+        }
+
+        if (matrix) {
+            std::vector<pathfinder::Cell> sources;
+            std::vector<pathfinder::Cell> targets;
+            for (const pathfinder::Query& query : queries) {
+                sources.push_back(query.start);
+                targets.push_back(query.goal);
+            }
+            auto start = std::chrono::steady_clock::now();
+            pathfinder::DistanceMatrix distances =
+                pathfinder::distanceMatrix(grid, sources, targets, threadCount, movement);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            double unit = movement.connectivity == pathfinder::Connectivity::Four ? 1.0 : pathfinder::DISTANCE_UNIT;
+            for (int s = 0; s < distances.sourceCount; ++s) {
+                for (int t = 0; t < distances.targetCount; ++t) {
+                    int distance = distances.at(s, t);
+                    if (distance == pathfinder::SearchSpace::UNREACHED) {
+                        std::printf(t ? " -" : "-");
+                    } else {
+                        std::printf(t ? " %.10g" : "%.10g", distance / unit);
+                    }
+                }
+                std::printf("\n");
+            }
+            std::fprintf(stderr, "%d x %d matrix, %.2f ms, %.0f pairs/s\n", distances.sourceCount,
+                         distances.targetCount, ms,
+                         ms > 0 ? static_cast<double>(distances.sourceCount) * distances.targetCount * 1000.0 / ms
+                                : 0.0);
+            return 0;
+        }
+
+        std::unique_ptr<pathfinder::LandmarkTable> landmarks;
+        if (useLandmarks) {
+            std::string path = pathfinder::landmarkFileFor(files[0]);
+            landmarks.reset(new pathfinder::LandmarkTable(pathfinder::loadLandmarkFile(path, grid)));
+        }
+
+        std::unique_ptr<pathfinder::PathCache> cache;
+        if (cacheCapacity > 0) {
+            cache.reset(new pathfinder::PathCache(cacheCapacity));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<pathfinder::SearchResult> results =
+            pathfinder::findPaths(grid, algorithm, queries, threadCount, movement, landmarks.get(), cache.get());
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::printf("%zu %d %.10g %d\n", i, results[i].found ? 1 : 0, results[i].distance, results[i].expansions);
+        }
+        std::fprintf(stderr, "%zu queries, %s, %.2f ms, %.0f queries/s\n", queries.size(),
+                     pathfinder::algorithmId(algorithm), ms, ms > 0 ? queries.size() * 1000.0 / ms : 0.0);
+        if (cache) {
+            pathfinder::PathCacheStats stats = cache->stats();
+            std::fprintf(stderr, "cache: %lld hits, %lld on a cached path, %lld misses, %lld evicted, %zu kept\n",
+                         stats.hits, stats.stretchHits, stats.misses, stats.evicted, cache->size());
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,225 @@
+// Benchmark harness: runs the engine's algorithms over the queries of a
+// MovingAI scenario and writes one CSV row per query and algorithm:
+//
+//     map,algorithm,query,bucket,found,cost,optimal,gap,expansions,pushes,stale_pops,reopenings,max_open,
+//     time_us,path_us,memory_bytes
+//
+// optimal is the cheapest cost under the same movement rules, found with
+// Dijkstra, and gap is cost / optimal - 1. Paths move four ways unless -8
+// lets them step diagonally without cutting corners, the rules the
+// scenario's own optimal lengths assume. path_us is the part of
+// time_us spent tracing the path back, memory_bytes the size of the buffers
+// the query used at their peak. The counters read 0 when the engine is built
+// with PATHFINDER_STATS=0. Per-algorithm totals go to standard error. The
+// map may also be a binary .grid file converted with tools/map_convert.cpp.
+//
+// -c checks that queries reuse their buffers: each algorithm first runs the
+// whole scenario once untimed, then every heap allocation made by a timed
+// query is counted, and the benchmark fails if there was any.
+//
+// -L gives A* and greedy best-first the landmarks saved next to the map by
+// tools/landmarks.cpp (city.map uses city.landmarks).
+//
+// Build: g++ -std=c++17 -O2 -I. tools/bench.cpp -o bench
+// Usage: bench [-a algorithm]... [-n max queries] [-8] [-c] [-L] map-file scen-file
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "engine/landmarks.hpp"
+#include "engine/map_io.hpp"
+#include "engine/search.hpp"
+
+namespace {
+
+// Heap allocations made through operator new so far
+long long allocationCount = 0;
+
+} // namespace
+
+// The replacements stay out of line: inlined into the engine's code, GCC would
+// see free() called on memory from operator new and warn
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+BENCH_NOINLINE void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+void printUsage(const char* program) {
+    std::fprintf(stderr, "usage: %s [-a algorithm]... [-n max queries] [-8] [-c] [-L] map-file scen-file\nalgorithms:",
+                 program);
+    for (pathfinder::Algorithm algorithm : pathfinder::ALGORITHMS) {
+        std::fprintf(stderr, " %s", pathfinder::algorithmId(algorithm));
+    }
+    std::fprintf(stderr, "\n");
+}
+
+struct Totals {
+    int queries = 0;
+    int found = 0;
+    long long expansions = 0;
+    long long pushes = 0;
+    long long stalePops = 0;
+    long long reopenings = 0;
+    double microseconds = 0.0;
+    double gap = 0.0;
+    size_t peakMemory = 0;
+    long long allocations = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<pathfinder::Algorithm> algorithms;
+    int maxQueries = -1;
+    pathfinder::Movement movement;
+    bool countAllocations = false;
+    bool useLandmarks = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-a" && i + 1 < argc) {
+            pathfinder::Algorithm algorithm;
+            if (!pathfinder::parseAlgorithm(argv[++i], algorithm)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            algorithms.push_back(algorithm);
+        } else if (argument == "-n" && i + 1 < argc) {
+            maxQueries = std::atoi(argv[++i]);
+        } else if (argument == "-8") {
+            movement.connectivity = pathfinder::Connectivity::Eight;
+        } else if (argument == "-c") {
+            countAllocations = true;
+        } else if (argument == "-L") {
+            useLandmarks = true;
+        } else {
+            files.push_back(argument);
+        }
+    }
+    if (files.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (algorithms.empty()) {
+        algorithms.assign(std::begin(pathfinder::ALGORITHMS), std::end(pathfinder::ALGORITHMS));
+    }
+
+    try {
+        pathfinder::Grid grid = pathfinder::loadMap(files[0]);
+        std::vector<pathfinder::ScenarioQuery> queries = pathfinder::loadMovingAiScenario(files[1]);
+        if (maxQueries >= 0 && static_cast<size_t>(maxQueries) < queries.size()) {
+            queries.resize(maxQueries);
+        }
+        for (const pathfinder::ScenarioQuery& query : queries) {
+            if (!grid.contains(query.start) || !grid.contains(query.goal)) {
+                std::fprintf(stderr, "scenario query lies outside the map\n");
+                return 1;
+            }
+        }
+
+        std::unique_ptr<pathfinder::LandmarkTable> landmarks;
+        if (useLandmarks) {
+            std::string path = pathfinder::landmarkFileFor(files[0]);
+            landmarks.reset(new pathfinder::LandmarkTable(pathfinder::loadLandmarkFile(path, grid)));
+        }
+
+        pathfinder::PathFinder finder(grid);
+        finder.setMovement(movement);
+        finder.setLandmarks(landmarks.get());
+        std::vector<double> optimal;
+        for (const pathfinder::ScenarioQuery& query : queries) {
+            optimal.push_back(finder.findPath(pathfinder::Algorithm::Dijkstra, query.start, query.goal).distance);
+        }
+
+        std::printf("map,algorithm,query,bucket,found,cost,optimal,gap,expansions,pushes,stale_pops,reopenings,"
+                    "max_open,time_us,path_us,memory_bytes\n");
+        long long failedChecks = 0;
+        for (pathfinder::Algorithm algorithm : algorithms) {
+            if (!queries.empty()) {
+                // Builds the JPS+ table outside the timed queries
+                finder.findPath(algorithm, queries[0].start, queries[0].start);
+            }
+            if (countAllocations) {
+                // Grows the buffers to what the largest query needs
+                for (const pathfinder::ScenarioQuery& query : queries) {
+                    finder.begin(algorithm, query.start, query.goal).run();
+                }
+            }
+            Totals totals;
+            for (size_t i = 0; i < queries.size(); ++i) {
+                long long allocationsBefore = allocationCount;
+                auto start = std::chrono::steady_clock::now();
+                pathfinder::Search search = finder.begin(algorithm, queries[i].start, queries[i].goal);
+                const pathfinder::SearchResult& result = search.run();
+                double microseconds =
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                totals.allocations += allocationCount - allocationsBefore;
+
+                const pathfinder::SearchStats& stats = result.stats;
+                double gap = result.found && optimal[i] > 0 ? result.distance / optimal[i] - 1.0 : 0.0;
+                std::printf("%s,%s,%zu,%d,%d,%.10g,%.10g,%.6f,%d,%d,%d,%d,%d,%.1f,%.1f,%zu\n", files[0].c_str(),
+                            pathfinder::algorithmId(algorithm), i, queries[i].bucket, result.found ? 1 : 0,
+                            result.distance, optimal[i], gap, result.expansions, stats.pushes, stats.stalePops,
+                            stats.reopenings, stats.maxOpenSize, microseconds, stats.pathMilliseconds * 1000.0,
+                            search.memoryUsage());
+
+                ++totals.queries;
+                totals.found += result.found ? 1 : 0;
+                totals.expansions += result.expansions;
+                totals.pushes += stats.pushes;
+                totals.stalePops += stats.stalePops;
+                totals.reopenings += stats.reopenings;
+                totals.microseconds += microseconds;
+                totals.gap += gap;
+                totals.peakMemory = std::max(totals.peakMemory, search.memoryUsage());
+            }
+            int count = std::max(1, totals.queries);
+            std::fprintf(stderr,
+                         "%-12s %6d queries %6d found | mean %10.1f us %10lld exp %10lld pushes %9lld stale "
+                         "%9lld reopened | gap %.4f | peak %zu bytes\n",
+                         pathfinder::algorithmId(algorithm), totals.queries, totals.found,
+                         totals.microseconds / count, totals.expansions / count, totals.pushes / count,
+                         totals.stalePops / count, totals.reopenings / count,
+                         totals.gap / std::max(1, totals.found), totals.peakMemory);
+            if (countAllocations && totals.allocations > 0) {
+                std::fprintf(stderr, "%-12s made %lld heap allocations after warming up\n",
+                             pathfinder::algorithmId(algorithm), totals.allocations);
+                ++failedChecks;
+            }
+        }
+        if (failedChecks > 0) {
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
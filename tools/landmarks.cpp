@@ -0,0 +1,68 @@
+// Builds the landmark table of engine/landmarks.hpp for a map and saves it
+// next to the map (city.map gets city.landmarks), where bench -L,
+// batch_query -L and the visualizer pick it up. Reports where the landmarks
+// went, how long building took and how large the table is. Rebuild after
+// editing the map: a table built for other walls or costs is rejected.
+//
+// Build: g++ -std=c++17 -O2 -I. tools/landmarks.cpp -o landmarks
+// Usage: landmarks [-k count] map-file [output-file]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "engine/landmarks.hpp"
+#include "engine/map_io.hpp"
+
+namespace {
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = pathfinder::LandmarkTable::DEFAULT_COUNT;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-k" && i + 1 < argc) {
+            count = std::atoi(argv[++i]);
+        } else {
+            files.push_back(argument);
+        }
+    }
+    if (files.empty() || files.size() > 2) {
+        std::fprintf(stderr, "usage: %s [-k count] map-file [output-file]\n", argv[0]);
+        return 1;
+    }
+    std::string output = files.size() == 2 ? files[1] : pathfinder::landmarkFileFor(files[0]);
+
+    try {
+        pathfinder::Grid grid = pathfinder::loadMap(files[0]);
+
+        auto start = std::chrono::steady_clock::now();
+        pathfinder::LandmarkTable table(grid, count);
+        double buildMilliseconds = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        pathfinder::saveLandmarkFile(table, output);
+        double saveMilliseconds = millisecondsSince(start);
+
+        for (int k = 0; k < table.count(); ++k) {
+            pathfinder::Cell cell = grid.cellAt(table.landmark(k));
+            std::printf("landmark %d: row %d, col %d\n", k, cell.row, cell.col);
+        }
+        std::fprintf(stderr, "%d landmarks%s, %.1f MB | build %.1f ms, save %.1f ms -> %s\n", table.count(),
+                     table.directed() ? " (both directions)" : "", table.memoryUsage() / 1048576.0, buildMilliseconds,
+                     saveMilliseconds, output.c_str());
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}